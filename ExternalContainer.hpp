@@ -0,0 +1,573 @@
+//ronamsalem4@gmail.com
+#ifndef __EXTERNALCONTAINER_HPP
+#define __EXTERNALCONTAINER_HPP
+#include "MyContainer.hpp"
+#include <vector>
+#include <string>
+#include <memory>
+#include <queue>
+#include <random>
+#include <atomic>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+#include <cstdlib>
+#include <unistd.h>
+/**
+ * A container for data sets that do not fit in memory.
+ * ExternalContainer keeps at most `budget` elements in memory. Whenever the in-memory buffer is full
+ * it is spilled to a temporary file (a segment), so the data lives in segments of exactly `budget`
+ * elements plus the current buffer.
+ * It offers the same six traversal orders and the same begin/end interface as MyContainer:
+ * - Order, ReverseOrder and MiddleOutOrder stream the segments back block by block.
+ * - AscendingIterator and DescendingIterator run an external k-way merge sort: every segment is
+ *   sorted in place into a run file when it is spilled (a query after adding elements only re-sorts
+ *   the in-memory buffer), and the runs are merged lazily while iterating.
+ * - SideCrossIterator merges the runs from both ends at the same time.
+ * Elements are written to disk as raw bytes, so T must be trivially copyable.
+ * Temporary files are created with mkstemp and all of them are removed when the container is destroyed.
+ */
+
+namespace ariel
+{
+    /**
+     * @class ---> ExternalContainer
+     * A spill-to-disk container with a bounded memory budget.
+     * @tparam ---> T The type of elements stored in the container (trivially copyable). Defaults to int.
+     */
+    template <typename T = int>
+    class ExternalContainer
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "ExternalContainer stores raw bytes, T must be trivially copyable");
+
+    private:
+        size_t budget;                                       //< Maximal number of elements kept in memory.
+        std::filesystem::path directory;                     //< Where the temporary files are created.
+        std::string prefix;                                  //< Unique file name prefix of this container.
+        mutable std::vector<T> buffer;                       //< Newest elements, not spilled yet (see build_runs).
+        std::vector<std::filesystem::path> segments;         //< Spilled elements, `budget` per file, insertion order.
+        mutable std::vector<std::filesystem::path> runs;     //< Sorted runs, one per segment plus one for the buffer.
+        mutable std::vector<size_t> run_sizes;               //< Number of elements in every run.
+        mutable bool runs_valid = false;                     //< False after every modification.
+        mutable bool buffer_run = false;                     //< The last run is the run of the buffer.
+
+        /**
+         * Creates a new empty file with a unique, unpredictable name (mkstemp, so it is created
+         * exclusively and only readable by the owner).
+         * @throws ---> std::runtime_error if the file cannot be created.
+         */
+        std::filesystem::path new_file() const
+        {
+            std::string name = (directory / (prefix + "XXXXXX")).string();
+            int fd = mkstemp(name.data());
+            if (fd < 0)
+            {
+                throw std::runtime_error("Cannot create spill file in " + directory.string());
+            }
+            close(fd);
+            return name;
+        }
+
+        static void write_file(const std::filesystem::path &file, const T *data, size_t count)
+        {
+            std::ofstream out(file, std::ios::binary | std::ios::trunc);
+            out.write(reinterpret_cast<const char *>(data), static_cast<std::streamsize>(count * sizeof(T)));
+            if (!out)
+            {
+                throw std::runtime_error("Cannot write spill file: " + file.string());
+            }
+        }
+
+        static void read_file(const std::filesystem::path &file, size_t offset, T *data, size_t count)
+        {
+            std::ifstream in(file, std::ios::binary);
+            in.seekg(static_cast<std::streamoff>(offset * sizeof(T)));
+            in.read(reinterpret_cast<char *>(data), static_cast<std::streamsize>(count * sizeof(T)));
+            if (!in)
+            {
+                throw std::runtime_error("Cannot read spill file: " + file.string());
+            }
+        }
+
+        static void remove_files(std::vector<std::filesystem::path> &files)
+        {
+            std::error_code ignored;
+            for (const auto &file : files)
+                std::filesystem::remove(file, ignored);
+            files.clear();
+        }
+
+        /**
+         * Number of elements read from disk at once by a single cursor.
+         */
+        size_t block_size(size_t cursors) const
+        {
+            return std::max<size_t>(1, budget / (cursors + 1));
+        }
+
+        /**
+         * Writes a full chunk of `budget` elements to a new segment file, then sorts the chunk in place
+         * and writes it as the segment's run, so a segment never has to be read back to be sorted.
+         * The chunk is left sorted.
+         */
+        void write_segment(std::vector<T> &chunk, std::vector<std::filesystem::path> &segment_files,
+                           std::vector<std::filesystem::path> &run_files) const
+        {
+            segment_files.push_back(new_file());
+            write_file(segment_files.back(), chunk.data(), chunk.size());
+            std::stable_sort(chunk.begin(), chunk.end());
+            run_files.push_back(new_file());
+            write_file(run_files.back(), chunk.data(), chunk.size());
+        }
+
+        /**
+         * Writes the full buffer to a new segment file and its run.
+         */
+        void spill()
+        {
+            if (buffer_run)
+            {
+                std::error_code ignored;
+                std::filesystem::remove(runs.back(), ignored);
+                runs.pop_back();
+                run_sizes.pop_back();
+                buffer_run = false;
+            }
+            write_segment(buffer, segments, runs);
+            run_sizes.push_back(budget);
+            buffer.clear();
+        }
+
+        /**
+         * Builds the run of the buffer. The runs of the segments are written when the segments are
+         * (see write_segment), so only the buffer is sorted here, and in place: its insertion order is
+         * saved to a scratch file first and read back afterwards, so memory stays within the budget.
+         */
+        void build_runs() const
+        {
+            if (runs_valid)
+                return;
+            if (buffer_run)
+            {
+                std::error_code ignored;
+                std::filesystem::remove(runs.back(), ignored);
+                runs.pop_back();
+                run_sizes.pop_back();
+                buffer_run = false;
+            }
+            if (!buffer.empty())
+            {
+                std::vector<std::filesystem::path> scratch{new_file()};
+                try
+                {
+                    write_file(scratch.front(), buffer.data(), buffer.size());
+                    std::stable_sort(buffer.begin(), buffer.end());
+                    runs.push_back(new_file());
+                    run_sizes.push_back(buffer.size());
+                    buffer_run = true;
+                    write_file(runs.back(), buffer.data(), buffer.size());
+                    read_file(scratch.front(), 0, buffer.data(), buffer.size());
+                }
+                catch (...)
+                {
+                    remove_files(scratch);
+                    throw;
+                }
+                remove_files(scratch);
+            }
+            runs_valid = true;
+        }
+
+        /**
+         * @class ---> BlockReader
+         * Random access to one file of fixed-size records through a cached block.
+         * Sequential access in either direction reads the file one block at a time.
+         */
+        class BlockReader
+        {
+        private:
+            std::filesystem::path file;
+            size_t count = 0;
+            size_t block = 1;
+            std::vector<T> cache;
+            size_t cache_start = 0;
+
+        public:
+            BlockReader() = default;
+            BlockReader(std::filesystem::path f, size_t n, size_t blk) : file(std::move(f)), count(n), block(blk) {}
+
+            T at(size_t i)
+            {
+                if (cache.empty() || i < cache_start || i >= cache_start + cache.size())
+                {
+                    cache_start = i - i % block;
+                    cache.resize(std::min(block, count - cache_start));
+                    read_file(file, cache_start, cache.data(), cache.size());
+                }
+                return cache[i - cache_start];
+            }
+        };
+
+        /**
+         * @class ---> SequenceReader
+         * Random access to the whole insertion-order sequence (segments followed by the buffer).
+         */
+        class SequenceReader
+        {
+        private:
+            const ExternalContainer *container;
+            BlockReader reader;
+            size_t current = static_cast<size_t>(-1); //< Segment the reader is attached to.
+
+        public:
+            explicit SequenceReader(const ExternalContainer *c) : container(c) {}
+
+            T at(size_t i)
+            {
+                size_t spilled = container->segments.size() * container->budget;
+                if (i >= spilled)
+                    return container->buffer[i - spilled];
+                size_t segment = i / container->budget;
+                if (segment != current)
+                {
+                    reader = BlockReader(container->segments[segment], container->budget, container->block_size(2));
+                    current = segment;
+                }
+                return reader.at(i % container->budget);
+            }
+        };
+
+        /**
+         * Source of the elements of one traversal, produced one by one.
+         */
+        struct Stream
+        {
+            virtual ~Stream() = default;
+            virtual T next() = 0;
+        };
+
+        /**
+         * Insertion-order based traversals: every position is mapped to an index of the sequence.
+         * Two readers are used so that MiddleOutOrder, which alternates between the two halves,
+         * does not reload a block on every step.
+         */
+        class PositionStream : public Stream
+        {
+        private:
+            TraversalOrder order;
+            size_t total;
+            size_t position = 0;
+            SequenceReader left;
+            SequenceReader right;
+
+        public:
+            PositionStream(const ExternalContainer *c, TraversalOrder o)
+                : order(o), total(c->size()), left(c), right(c) {}
+
+            T next() override
+            {
+                size_t pos = position++;
+                size_t i = pos;
+                if (order == TraversalOrder::Reverse)
+                    i = total - 1 - pos;
+                else if (order == TraversalOrder::MiddleOut)
+                    i = detail::middle_out_index(total, pos);
+                return (i < (total - 1) / 2) ? left.at(i) : right.at(i);
+            }
+        };
+
+        /**
+         * K-way merge of the sorted runs, smallest first or largest first.
+         * Ties are taken from the earlier run first when ascending and from the later run first when
+         * descending, so the descending traversal is exactly the reverse of the ascending one.
+         */
+        class MergeStream : public Stream
+        {
+        private:
+            struct Head
+            {
+                T value;
+                size_t run;
+            };
+            struct Later
+            {
+                bool ascending;
+                bool operator()(const Head &a, const Head &b) const
+                {
+                    if (ascending)
+                        return (b.value < a.value) || (!(a.value < b.value) && a.run > b.run);
+                    return (a.value < b.value) || (!(b.value < a.value) && a.run < b.run);
+                }
+            };
+            bool ascending;
+            std::vector<BlockReader> readers;
+            std::vector<size_t> consumed;
+            std::vector<size_t> sizes;
+            std::priority_queue<Head, std::vector<Head>, Later> heads;
+
+            void load(size_t run)
+            {
+                if (consumed[run] == sizes[run])
+                    return;
+                size_t i = ascending ? consumed[run] : sizes[run] - 1 - consumed[run];
+                consumed[run]++;
+                heads.push(Head{readers[run].at(i), run});
+            }
+
+        public:
+            MergeStream(const ExternalContainer *c, bool asc, size_t streams)
+                : ascending(asc), consumed(c->runs.size(), 0), sizes(c->run_sizes), heads(Later{asc})
+            {
+                size_t block = c->block_size(c->runs.size() * streams);
+                for (size_t r = 0; r < c->runs.size(); r++)
+                    readers.emplace_back(c->runs[r], c->run_sizes[r], block);
+                for (size_t r = 0; r < c->runs.size(); r++)
+                    load(r);
+            }
+
+            T next() override
+            {
+                Head top = heads.top();
+                heads.pop();
+                load(top.run);
+                return top.value;
+            }
+        };
+
+        /**
+         * Side-cross traversal: alternates between an ascending and a descending merge.
+         */
+        class SideCrossStream : public Stream
+        {
+        private:
+            MergeStream low;
+            MergeStream high;
+            bool take_low = true;
+
+        public:
+            explicit SideCrossStream(const ExternalContainer *c) : low(c, true, 2), high(c, false, 2) {}
+
+            T next() override
+            {
+                bool from_low = take_low;
+                take_low = !take_low;
+                return from_low ? low.next() : high.next();
+            }
+        };
+
+    public:
+        /**
+         * @class ---> Iterator
+         * Single-pass iterator over one traversal order of an ExternalContainer.
+         * Copies share the underlying stream, so only one copy should be advanced (input iterator).
+         * Modifying the container invalidates all of its iterators.
+         */
+        class Iterator
+        {
+        private:
+            const ExternalContainer *container;
+            std::shared_ptr<Stream> stream;
+            size_t index;
+            size_t total;
+            T current{};
+
+        public:
+            Iterator(const ExternalContainer &contain, std::shared_ptr<Stream> source, bool end)
+                : container(&contain), stream(std::move(source)), index(end ? contain.size() : 0), total(contain.size())
+            {
+                if (index < total)
+                    current = stream->next();
+            }
+
+            /**
+             * Dereference operator to access current element.
+             * @throws ---> std::out_of_range if the index is beyond the end.
+             */
+            T operator*() const
+            {
+                if (index >= total)
+                {
+                    throw std::out_of_range("Dereferencing past-the-end iterator");
+                }
+                return current;
+            }
+
+            Iterator &operator++()
+            {
+                if (++index < total)
+                    current = stream->next();
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator temp = *this;
+                ++(*this);
+                return temp;
+            }
+
+            bool operator==(const Iterator &other) const { return index == other.index; }
+
+            /**
+             * @throws---->  std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator!=(const Iterator &other) const
+            {
+                if (container != other.container)
+                {
+                    throw std::invalid_argument("Cannot compare iterators from different containers");
+                }
+                return index != other.index;
+            }
+        };
+
+        /**
+         * Creates an empty container.
+         * @param memory_budget ---> Maximal number of elements kept in memory (at least 1).
+         * @param temp_dir ---> Directory for the spill and run files. Defaults to the system temp directory.
+         * @throws ---> std::invalid_argument if the budget is zero.
+         */
+        explicit ExternalContainer(size_t memory_budget = 1 << 20,
+                                   std::filesystem::path temp_dir = std::filesystem::temp_directory_path())
+            : budget(memory_budget), directory(std::move(temp_dir))
+        {
+            if (budget == 0)
+            {
+                throw std::invalid_argument("Memory budget must be positive");
+            }
+            static std::atomic<unsigned long> instances{0};
+            prefix = "ariel_ext_" + std::to_string(std::random_device{}()) + "_" + std::to_string(instances++) + "_";
+            buffer.reserve(budget);
+        }
+
+        ExternalContainer(const ExternalContainer &) = delete;
+        ExternalContainer &operator=(const ExternalContainer &) = delete;
+
+        ~ExternalContainer()
+        {
+            remove_files(segments);
+            remove_files(runs);
+        }
+
+        /**
+         * Adds an element to the container, spilling the buffer to disk when it is full.
+         * @param val ---> The element to be added.
+         */
+        void addElement(const T &val)
+        {
+            buffer.push_back(val);
+            runs_valid = false;
+            if (buffer.size() == budget)
+                spill();
+        }
+
+        /**
+         * Removes all occurrences of an element. The data is rewritten in one streaming pass,
+         * using about twice the memory budget.
+         * @param val ---> The element to be removed.
+         * @throws ---> std::invalid_argument if the element is not found.
+         */
+        void removeElement(const T &val)
+        {
+            std::vector<std::filesystem::path> kept, kept_runs;
+            std::vector<T> out;
+            out.reserve(budget);
+            SequenceReader reader(this);
+            size_t total = size(), removed = 0;
+            try
+            {
+                for (size_t i = 0; i < total; i++)
+                {
+                    T item = reader.at(i);
+                    if (item == val)
+                    {
+                        removed++;
+                        continue;
+                    }
+                    out.push_back(item);
+                    if (out.size() == budget)
+                    {
+                        write_segment(out, kept, kept_runs);
+                        out.clear();
+                    }
+                }
+            }
+            catch (...)
+            {
+                remove_files(kept);
+                remove_files(kept_runs);
+                throw;
+            }
+            if (removed == 0)
+            {
+                remove_files(kept);
+                remove_files(kept_runs);
+                throw std::invalid_argument("Element not found in container");
+            }
+            remove_files(segments);
+            remove_files(runs);
+            run_sizes.assign(kept_runs.size(), budget);
+            buffer_run = false;
+            runs = std::move(kept_runs);
+            segments = std::move(kept);
+            buffer = std::move(out);
+            buffer.reserve(budget);
+            runs_valid = false;
+        }
+
+        /**
+         * Returns the number of elements currently in the container (in memory and on disk).
+         */
+        size_t size() const
+        {
+            return segments.size() * budget + buffer.size();
+        }
+
+        /**
+         * Returns the number of segments spilled to disk.
+         */
+        size_t segment_count() const { return segments.size(); }
+
+        /**
+         * Prints all elements in insertion order.
+         */
+        friend std::ostream &operator<<(std::ostream &os, const ExternalContainer &container)
+        {
+            for (auto it = container.begin_order(); it != container.end_order(); ++it)
+                os << *it << " ";
+            return os;
+        }
+
+        Iterator begin_ascending_order() const { return sorted(true); }
+        Iterator end_ascending_order() const { return Iterator(*this, nullptr, true); }
+        Iterator begin_descending_order() const { return sorted(false); }
+        Iterator end_descending_order() const { return Iterator(*this, nullptr, true); }
+        Iterator begin_side_cross_order() const
+        {
+            build_runs();
+            return Iterator(*this, std::make_shared<SideCrossStream>(this), false);
+        }
+        Iterator end_side_cross_order() const { return Iterator(*this, nullptr, true); }
+        Iterator begin_reverse_order() const { return positional(TraversalOrder::Reverse); }
+        Iterator end_reverse_order() const { return Iterator(*this, nullptr, true); }
+        Iterator begin_order() const { return positional(TraversalOrder::Insertion); }
+        Iterator end_order() const { return Iterator(*this, nullptr, true); }
+        Iterator begin_middle_out_order() const { return positional(TraversalOrder::MiddleOut); }
+        Iterator end_middle_out_order() const { return Iterator(*this, nullptr, true); }
+
+    private:
+        Iterator sorted(bool ascending) const
+        {
+            build_runs();
+            return Iterator(*this, std::make_shared<MergeStream>(this, ascending, 1), false);
+        }
+
+        Iterator positional(TraversalOrder order) const
+        {
+            return Iterator(*this, std::make_shared<PositionStream>(this, order), false);
+        }
+    };
+}
+#endif
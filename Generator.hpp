@@ -0,0 +1,141 @@
+//ronamsalem4@gmail.com
+#ifndef __GENERATOR_HPP
+#define __GENERATOR_HPP
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <utility>
+/**
+ * A minimal C++20 coroutine generator, returned by MyContainer::generate.
+ * The coroutine body runs only when the next element is requested and is suspended after every
+ * co_yield, so a traversal can be consumed a few elements at a time, interleaved with other
+ * generators on the same thread, or abandoned early without doing the remaining work.
+ * A Generator can be used in a range-for loop, or pulled one element at a time with next().
+ */
+
+namespace ariel
+{
+    /**
+     * @class ---> Generator
+     * Owns a suspended coroutine that yields values of type T.
+     * @tparam ---> T The type of the yielded values.
+     */
+    template <typename T>
+    class Generator
+    {
+    public:
+        struct promise_type
+        {
+            const T *current = nullptr; //< The value of the last co_yield (alive while suspended).
+            std::exception_ptr error;
+
+            Generator get_return_object() { return Generator(std::coroutine_handle<promise_type>::from_promise(*this)); }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            std::suspend_always yield_value(const T &value) noexcept
+            {
+                current = std::addressof(value);
+                return {};
+            }
+            void return_void() {}
+            void unhandled_exception() { error = std::current_exception(); }
+        };
+
+    private:
+        std::coroutine_handle<promise_type> handle;
+
+        explicit Generator(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+        /**
+         * Runs the coroutine to its next co_yield (or its end).
+         * @throws ---> Whatever the coroutine body threw.
+         */
+        void advance() const
+        {
+            handle.resume();
+            if (handle.promise().error)
+                std::rethrow_exception(std::exchange(handle.promise().error, nullptr));
+        }
+
+    public:
+        Generator(Generator &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+        Generator &operator=(Generator &&other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle)
+                    handle.destroy();
+                handle = std::exchange(other.handle, nullptr);
+            }
+            return *this;
+        }
+
+        Generator(const Generator &) = delete;
+        Generator &operator=(const Generator &) = delete;
+
+        ~Generator()
+        {
+            if (handle)
+                handle.destroy();
+        }
+
+        /**
+         * Resumes the coroutine and returns the next value, or std::nullopt when the traversal is over.
+         */
+        std::optional<T> next()
+        {
+            if (!handle || handle.done())
+                return std::nullopt;
+            advance();
+            if (handle.done())
+                return std::nullopt;
+            return *handle.promise().current;
+        }
+
+        /**
+         * @class ---> Iterator
+         * Input iterator over the remaining values; it compares equal to std::default_sentinel at the end.
+         */
+        class Iterator
+        {
+        private:
+            std::coroutine_handle<promise_type> handle;
+
+        public:
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+
+            explicit Iterator(std::coroutine_handle<promise_type> h) : handle(h) {}
+
+            const T &operator*() const { return *handle.promise().current; }
+
+            Iterator &operator++()
+            {
+                handle.resume();
+                if (handle.promise().error)
+                    std::rethrow_exception(std::exchange(handle.promise().error, nullptr));
+                return *this;
+            }
+
+            void operator++(int) { ++(*this); }
+
+            bool operator==(std::default_sentinel_t) const { return !handle || handle.done(); }
+        };
+
+        /**
+         * Starts (or continues) the traversal: runs the coroutine to its first pending value.
+         */
+        Iterator begin()
+        {
+            if (handle && !handle.done())
+                advance();
+            return Iterator(handle);
+        }
+
+        std::default_sentinel_t end() const { return std::default_sentinel; }
+    };
+}
+#endif
@@ -0,0 +1,209 @@
+//ronamsalem4@gmail.com
+#ifndef __KEYEDCONTAINER_HPP
+#define __KEYEDCONTAINER_HPP
+#include "MyContainer.hpp"
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+/**
+ * A structure-of-arrays container for records that are ordered by one key field.
+ * KeyedContainer stores the sort key of every record in its own column, next to the column of records.
+ * The value-ordered iterators sort only the key column together with an index (with the same sort
+ * engine as MyContainer, so integral keys are radix sorted), and a record is read from the record
+ * column only when an iterator is dereferenced. Sorting therefore moves small keys instead of whole records.
+ * It offers the same six traversal orders and begin/end interface as MyContainer; the iterators return
+ * const references to the stored records instead of copies.
+ * The sorted permutation is kept until the next modification. Any modification invalidates the iterators;
+ * dereferencing such an iterator throws std::logic_error.
+ */
+
+namespace ariel
+{
+    /**
+     * @class ---> KeyedContainer
+     * @tparam ---> T The record type.
+     * @tparam ---> Projection Extracts the key of a record (for example a pointer to member).
+     * @tparam ---> Compare Strict weak ordering of the keys. Defaults to std::less<>.
+     */
+    template <typename T, typename Projection, typename Compare = std::less<>>
+    class KeyedContainer
+    {
+    public:
+        using key_type = std::remove_cvref_t<std::invoke_result_t<const Projection &, const T &>>;
+
+    private:
+        std::vector<key_type> keys;         //< Key column.
+        std::vector<T> records;             //< Record column, same index as the key column.
+        [[no_unique_address]] Projection proj;
+        [[no_unique_address]] Compare comp;
+        mutable std::vector<size_t> sorted; //< Ascending permutation of the key column.
+        mutable bool sorted_valid = false;  //< False after every modification.
+        std::uint64_t modifications = 0;    //< Incremented by every modification (checked by the iterators).
+
+        const std::vector<size_t> &sorted_index() const
+        {
+            if (!sorted_valid)
+            {
+                sorted = detail::sorted_permutation(keys, comp, std::identity());
+                sorted_valid = true;
+            }
+            return sorted;
+        }
+
+    public:
+        /**
+         * Creates an empty container.
+         * @param projection ---> The key extractor.
+         * @param compare ---> The comparator of the keys.
+         */
+        explicit KeyedContainer(Projection projection = Projection(), Compare compare = Compare())
+            : proj(std::move(projection)), comp(std::move(compare)) {}
+
+        /**
+         *  Adds a record; its key is extracted once, here.
+         * @param val ---> The record to be added.
+         */
+        void addElement(const T &val)
+        {
+            keys.push_back(std::invoke(proj, val));
+            records.push_back(val);
+            sorted_valid = false;
+            modifications++;
+        }
+
+        /**
+         * Removes all records equal to val from both columns.
+         * @param val ---> The record to be removed.
+         * @throws ---> std::invalid_argument if the element is not found.
+         */
+        void removeElement(const T &val)
+        {
+            size_t kept = 0;
+            for (size_t i = 0; i < records.size(); i++)
+            {
+                if (records[i] == val)
+                    continue;
+                if (kept != i)
+                {
+                    keys[kept] = std::move(keys[i]);
+                    records[kept] = std::move(records[i]);
+                }
+                kept++;
+            }
+            if (kept == records.size())
+            {
+                throw std::invalid_argument("Element not found in container");
+            }
+            keys.erase(keys.begin() + static_cast<std::ptrdiff_t>(kept), keys.end());
+            records.erase(records.begin() + static_cast<std::ptrdiff_t>(kept), records.end());
+            sorted_valid = false;
+            modifications++;
+        }
+
+        /**
+         * Returns the number of records currently in the container.
+         */
+        size_t size() const { return records.size(); }
+
+        /**
+         *  Prints all records in insertion order.
+         */
+        friend std::ostream &operator<<(std::ostream &os, const KeyedContainer &container)
+        {
+            for (const auto &record : container.records)
+                os << record << " ";
+            return os;
+        }
+
+        /**
+         * @class ---> Iterator
+         * Iterator over one of the six traversal orders. A position is mapped to a record index
+         * (through the sorted permutation for the value orders) and the record is gathered on dereference.
+         * The size and the modification count are captured at construction, so an iterator never maps a
+         * position through a permutation of another size.
+         */
+        class Iterator
+        {
+        private:
+            const KeyedContainer *container;
+            TraversalOrder order;
+            const size_t *sorted; //< Sorted permutation (value orders only).
+            size_t count;         //< Number of records when the iterator was created.
+            std::uint64_t modifications;
+            size_t index;
+
+        public:
+            Iterator(const KeyedContainer &contain, TraversalOrder o, bool end)
+                : container(&contain), order(o), sorted(nullptr), count(contain.size()),
+                  modifications(contain.modifications), index(end ? contain.size() : 0)
+            {
+                if (!end && detail::is_value_order(o))
+                    sorted = contain.sorted_index().data();
+            }
+
+            /**
+             * Dereference operator to access current record.
+             * @throws ---> std::out_of_range if the index is beyond the end, std::logic_error if the
+             * container was modified after the iterator was created.
+             */
+            const T &operator*() const
+            {
+                if (modifications != container->modifications)
+                {
+                    throw std::logic_error("Iterator used after its container was modified");
+                }
+                if (index >= count)
+                {
+                    throw std::out_of_range("Dereferencing past-the-end iterator");
+                }
+                return container->records[detail::traversal_index(order, count, index, sorted)];
+            }
+
+            const T *operator->() const { return &**this; }
+
+            Iterator &operator++()
+            {
+                index++;
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator temp = *this;
+                ++(*this);
+                return temp;
+            }
+
+            bool operator==(const Iterator &other) const { return index == other.index; }
+
+            /**
+             * @throws---->  std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator!=(const Iterator &other) const
+            {
+                if (container != other.container)
+                {
+                    throw std::invalid_argument("Cannot compare iterators from different containers");
+                }
+                return index != other.index;
+            }
+        };
+
+        Iterator begin_ascending_order() const { return Iterator(*this, TraversalOrder::Ascending, false); }
+        Iterator end_ascending_order() const { return Iterator(*this, TraversalOrder::Ascending, true); }
+        Iterator begin_descending_order() const { return Iterator(*this, TraversalOrder::Descending, false); }
+        Iterator end_descending_order() const { return Iterator(*this, TraversalOrder::Descending, true); }
+        Iterator begin_side_cross_order() const { return Iterator(*this, TraversalOrder::SideCross, false); }
+        Iterator end_side_cross_order() const { return Iterator(*this, TraversalOrder::SideCross, true); }
+        Iterator begin_reverse_order() const { return Iterator(*this, TraversalOrder::Reverse, false); }
+        Iterator end_reverse_order() const { return Iterator(*this, TraversalOrder::Reverse, true); }
+        Iterator begin_order() const { return Iterator(*this, TraversalOrder::Insertion, false); }
+        Iterator end_order() const { return Iterator(*this, TraversalOrder::Insertion, true); }
+        Iterator begin_middle_out_order() const { return Iterator(*this, TraversalOrder::MiddleOut, false); }
+        Iterator end_middle_out_order() const { return Iterator(*this, TraversalOrder::MiddleOut, true); }
+    };
+}
+#endif
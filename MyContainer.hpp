@@ -4,448 +4,2583 @@
 #include <vector>
 #include <iterator>
 #include <algorithm>
+#include <functional>
+#include <utility>
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include <optional>
+#include <cmath>
+#include <span>
+#include <memory>
+#include <unordered_map>
+#include "ThreadPool.hpp"
+#include "SimdKernels.hpp"
+#include "SmallVector.hpp"
+#include "Generator.hpp"
 /**
  * A generic container class with multiple custom iteration strategies.
  * The MyContainer class is a templated container that stores elements in a dynamic array (std::vector).
  * It supports basic operations such as adding and removing elements, and provides several iterator types
  * to traverse the elements in different logical orders:
  1. AscendingIterator: Iterates from smallest to largest.
- 2.  DescendingIterator: Iterates from largest to smallest.
+ 2.  DescendingIterator: Iterates from largest to smallest (the exact reverse of AscendingIterator).
  3. SideCrossIterator: Alternates between the lowest and highest remaining elements.
  4.  ReverseOrder: Iterates in reverse insertion order.
  5.  Order: Iterates in the original insertion order.
  6. MiddleOutOrder: Starts from the middle and expands outward alternately.
  * All iterators inherit from a common abstract base class, BaseIterator, which implements shared logic  such as dereferencing, incrementing, and comparison. Each derived iterator class constructs its ow traversal order while reusing this common functionality.
  * Each iterator class also includes static begin() and end() methods as required, making them usable independently for container traversal.
+ * The value-ordered iterators compare elements with a Compare functor applied to a Projection of every element
+ * (std::less<> and std::identity by default), so records can be ordered by one of their fields.
  * The container throws exceptions when attempting to remove a non-existent elemen.
  */
 
 namespace ariel
 {
     /**
-     * @class --->  MyContainer
-     *  A templated container class that holds elements and provides multiple iteration strategies.
-     * This container supports dynamic insertion and removal of elements and provides size querying and
-     * printing functionalities. It serves as a basis for various custom iterators implemented as inner classes.
-     * @tparam ---> T The type of elements stored in the container. Defaults to int.
+     * Selects one of the six traversal orders of MyContainer.
+     * Used by the functions that receive the order as a runtime argument (for example export_async).
      */
-    template <typename T = int> //< Internal storage of elements.
-    class MyContainer
+    enum class TraversalOrder
     {
+        Ascending,
+        Descending,
+        SideCross,
+        Reverse,
+        Insertion,
+        MiddleOut
+    };
 
-    private:
-        std::vector<T> elements;
+    /**
+     * Output format of MyContainer::export_async.
+     * Text ---> elements separated by a single space (same as operator<<).
+     * Lines ---> one element per line.
+     * Binary ---> the raw bytes of every element (trivially copyable types only).
+     */
+    enum class ExportFormat
+    {
+        Text,
+        Lines,
+        Binary
+    };
 
-    public:
+    /**
+     * Customization point for cached sort keys.
+     * Specialize sort_key<Key> to let the sort engine compare a compact 64-bit key instead of the key itself:
+     *  - `static std::uint64_t make(const Key &)` must be monotone: make(a) < make(b) only if a < b.
+     *  - `static constexpr bool exact` tells whether equal 64-bit keys mean equal keys; when it is false,
+     *    ties are resolved with the full comparison.
+     * Used with std::less / std::greater only. Provided for std::string and std::string_view (8-byte prefix).
+     */
+    template <typename Key>
+    struct sort_key
+    {
+        static constexpr bool enabled = false;
+    };
+
+    /**
+     * 8-byte big-endian prefix of a string: comparing two prefixes as integers gives the same result
+     * as comparing the first 8 characters, so only strings that share their first 8 bytes need a full compare.
+     */
+    template <>
+    struct sort_key<std::string_view>
+    {
+        static constexpr bool enabled = true;
+        static constexpr bool exact = false;
+        static std::uint64_t make(std::string_view str)
+        {
+            std::uint64_t key = 0;
+            for (size_t i = 0; i < 8; i++)
+            {
+                key <<= 8;
+                if (i < str.size())
+                    key |= static_cast<unsigned char>(str[i]);
+            }
+            return key;
+        }
+    };
+
+    template <>
+    struct sort_key<std::string> : sort_key<std::string_view>
+    {
+    };
+
+    namespace detail
+    {
         /**
-         *  Adds an element to the container.
-         * @param val ---> The element to be added.
+         * Maps a position of the middle-out traversal to an index of the underlying sequence.
+         * Matches MiddleOutOrder: the (left) middle first, then left/right alternately and
+         * finally whatever is left on the right side.
+         * @param n ---> Number of elements (must be positive).
+         * @param pos ---> Position in the traversal, smaller than n.
+         * @return ---> The index in insertion order.
          */
-        void addElement(const T &val) { elements.push_back(val); }
+        constexpr size_t middle_out_index(size_t n, size_t pos)
+        {
+            size_t middle = (n - 1) / 2;
+            if (pos == 0)
+                return middle;
+            if (pos <= 2 * middle)
+                return (pos % 2 == 1) ? middle - (pos + 1) / 2 : middle + pos / 2;
+            return pos;
+        }
 
         /**
-         * Removes the first occurrence of an element from the container.
-         * @param val ---> The element to be removed.
-         * @throws ---> std::invalid_argument if the element is not found.
+         * Maps a position of any traversal order to an index in insertion order, without building the order.
+         * @param order ---> The traversal order.
+         * @param n ---> Number of elements (must be positive).
+         * @param pos ---> Position in the traversal, smaller than n.
+         * @param sorted ---> The stable ascending permutation (only read by the value orders).
+         * @return ---> The index in insertion order of the element visited at that position.
          */
-        void removeElement(const T &val)
+        constexpr size_t traversal_index(TraversalOrder order, size_t n, size_t pos, const size_t *sorted)
         {
-            auto original_size = elements.size();
-            elements.erase(std::remove(elements.begin(), elements.end(), val), elements.end());
-            if (elements.size() == original_size)
+            switch (order)
             {
-                throw std::invalid_argument("Element not found in container");
+            case TraversalOrder::Ascending:
+                return sorted[pos];
+            case TraversalOrder::Descending:
+                return sorted[n - 1 - pos];
+            case TraversalOrder::SideCross:
+                return (pos % 2 == 0) ? sorted[pos / 2] : sorted[n - 1 - pos / 2];
+            case TraversalOrder::Reverse:
+                return n - 1 - pos;
+            case TraversalOrder::MiddleOut:
+                return middle_out_index(n, pos);
+            case TraversalOrder::Insertion:
+                break;
             }
+            return pos;
         }
+
         /**
-         *  Returns the number of elements currently in the container.
-         * @return ---> The size of the container.
+         * True for the orders that are defined by the values (and need the sorted permutation).
          */
-        size_t size() const
+        constexpr bool is_value_order(TraversalOrder order)
         {
-            return elements.size();
+            return order == TraversalOrder::Ascending || order == TraversalOrder::Descending || order == TraversalOrder::SideCross;
         }
 
+        template <typename C>
+        struct is_std_less : std::false_type
+        {
+        };
+        template <typename K>
+        struct is_std_less<std::less<K>> : std::true_type
+        {
+        };
+        template <typename C>
+        struct is_std_greater : std::false_type
+        {
+        };
+        template <typename K>
+        struct is_std_greater<std::greater<K>> : std::true_type
+        {
+        };
+
         /**
-         *  Prints all elements in the container to the output stream.
-         * @param os ---> The output stream.
-         * @param container ---> The container to print.
-         * @return ---> A reference to the output stream.
+         * True when the comparator is std::less or std::greater, i.e. the order of the key type itself.
          */
-        friend std::ostream &operator<<(std::ostream &os, const MyContainer<T> &container)
-        {
-            for (auto iterator = container.elements.begin(); iterator != container.elements.end(); iterator++)
-                os << *iterator << " ";
-            return os;
-        }
+        template <typename Compare>
+        inline constexpr bool is_natural_order_v = is_std_less<Compare>::value || is_std_greater<Compare>::value;
 
         /**
-         * @class BaseIterator
-         *  base class for iterators over MyContainer.
-         * This class provides common logic for all iterators such as element access,
-         * increment, and comparison operations. Each derived iterator defines its own traversal order.
+         * True when std::hash can hash the key type.
          */
+        template <typename Key, typename = void>
+        struct is_hashable : std::false_type
+        {
+        };
 
-        class BaseIterator
+        template <typename Key>
+        struct is_hashable<Key, std::void_t<decltype(std::hash<Key>()(std::declval<const Key &>()))>> : std::true_type
         {
-        protected:
-            const MyContainer<T> &container; //< Reference to the container being iterated.
-            std::vector<T> order;            //< Ordered list of elements to iterate over.
-            size_t index;                    //< Current index in the iteration.
+        };
 
-        public:
-            /**
-             *  Constructs a BaseIterator with a given container and order.
-             * @param contain ---> The container to iterate.
-             * @param vec ---> The traversal order of elements.
-             */
-            BaseIterator(const MyContainer<T> &contain, std::vector<T> vec)
-                : container(contain), order(std::move(vec)), index(0) {}
+        template <typename Key, typename = void>
+        struct has_sort_key : std::false_type
+        {
+        };
+        template <typename Key>
+        struct has_sort_key<Key, std::enable_if_t<sort_key<Key>::enabled>> : std::true_type
+        {
+        };
 
-            /**
-             * Dereference operator to access current element.
-             * @return ---> The current element.
-             * @throws --->  std::out_of_range if the index is beyond the end.
-             */
-            T operator*() const
+        /**
+         * Below this size the radix kernel is not worth its passes over the data.
+         */
+        inline constexpr size_t RADIX_MIN = 64;
+
+        /**
+         * Hash counting of the distinct keys (see grouped_ascending) is abandoned once more than one key
+         * in this many is distinct.
+         */
+        inline constexpr size_t DISTINCT_HASH_RATIO = 8;
+
+        /**
+         * Stable LSD radix sort of (key, index) pairs by an unsigned key, one byte per pass.
+         * Passes in which all keys share the same byte are skipped.
+         */
+        template <typename U>
+        void radix_sort(std::vector<std::pair<U, size_t>> &items)
+        {
+            std::vector<std::pair<U, size_t>> scratch(items.size());
+            for (size_t shift = 0; shift < sizeof(U) * 8; shift += 8)
             {
-                if (index >= order.size())
+                size_t count[257] = {0};
+                for (const auto &item : items)
+                    count[((item.first >> shift) & 0xFF) + 1]++;
+                if (std::find(count + 1, count + 257, items.size()) != count + 257)
+                    continue;
+                for (size_t b = 1; b < 257; b++)
+                    count[b] += count[b - 1];
+                for (const auto &item : items)
+                    scratch[count[(item.first >> shift) & 0xFF]++] = item;
+                items.swap(scratch);
+            }
+        }
+
+        /**
+         * Computes the stable ascending permutation of a sequence: position i of the result holds the
+         * index of the i-th smallest element, equal keys keep their insertion order.
+         * The kernel is chosen at compile time from the projected key type:
+         * - integral keys ordered by std::less / std::greater: radix sort of (key, index) pairs.
+         * - other arithmetic keys ordered by std::less / std::greater: comparison sort of (key, index) pairs,
+         *   so keys are compared from a contiguous buffer without calling the projection again.
+         * - keys with a sort_key specialization (strings) ordered by std::less / std::greater: comparison sort
+         *   of (cached 64-bit key, index) pairs; the elements are only touched when two cached keys tie.
+         * - anything else: std::stable_sort of indices with comp(proj(a), proj(b)).
+         * @param elements ---> The elements, in insertion order (a std::vector or SmallVector).
+         * @param comp ---> Strict weak ordering of the projected keys.
+         * @param proj ---> Maps an element to its sort key.
+         * @return ---> The permutation of indices.
+         */
+        template <typename Sequence, typename Compare, typename Projection>
+        std::vector<size_t> sorted_permutation(const Sequence &elements, const Compare &comp, const Projection &proj)
+        {
+            using T = typename Sequence::value_type;
+            using Key = std::remove_cvref_t<std::invoke_result_t<const Projection &, const T &>>;
+            std::vector<size_t> result(elements.size());
+            if constexpr (std::is_arithmetic_v<Key> && is_natural_order_v<Compare>)
+            {
+                if constexpr (std::is_integral_v<Key> && !std::is_same_v<Key, bool>)
                 {
-                    throw std::out_of_range("Dereferencing past-the-end iterator");
+                    if (elements.size() >= RADIX_MIN)
+                    {
+                        using U = std::make_unsigned_t<Key>;
+                        std::vector<std::pair<U, size_t>> items(elements.size());
+                        for (size_t i = 0; i < elements.size(); i++)
+                        {
+                            U key = static_cast<U>(std::invoke(proj, elements[i]));
+                            if constexpr (std::is_signed_v<Key>)
+                                key ^= U(1) << (sizeof(U) * 8 - 1);
+                            if constexpr (is_std_greater<Compare>::value)
+                                key = static_cast<U>(~key);
+                            items[i] = {key, i};
+                        }
+                        radix_sort(items);
+                        for (size_t i = 0; i < items.size(); i++)
+                            result[i] = items[i].second;
+                        return result;
+                    }
                 }
-                return order.at(index);
+                std::vector<std::pair<Key, size_t>> items(elements.size());
+                for (size_t i = 0; i < elements.size(); i++)
+                    items[i] = {std::invoke(proj, elements[i]), i};
+                std::sort(items.begin(), items.end(), [&comp](const auto &a, const auto &b)
+                          { return comp(a.first, b.first) || (!comp(b.first, a.first) && a.second < b.second); });
+                for (size_t i = 0; i < items.size(); i++)
+                    result[i] = items[i].second;
             }
-
-            /**
-             *  Pre-increment operator.
-             * @return ---> Reference to this iterator after incrementing.
-             */
-            BaseIterator &operator++()
+            else if constexpr (has_sort_key<Key>::value && is_natural_order_v<Compare>)
             {
-                index++;
-                return *this;
+                std::vector<std::pair<std::uint64_t, size_t>> items(elements.size());
+                for (size_t i = 0; i < elements.size(); i++)
+                    items[i] = {sort_key<Key>::make(std::invoke(proj, elements[i])), i};
+                std::sort(items.begin(), items.end(), [&](const auto &a, const auto &b)
+                          {
+                    if (a.first != b.first)
+                        return is_std_greater<Compare>::value ? a.first > b.first : a.first < b.first;
+                    if constexpr (!sort_key<Key>::exact)
+                    {
+                        const Key &ka = std::invoke(proj, elements[a.second]);
+                        const Key &kb = std::invoke(proj, elements[b.second]);
+                        if (comp(ka, kb))
+                            return true;
+                        if (comp(kb, ka))
+                            return false;
+                    }
+                    return a.second < b.second; });
+                for (size_t i = 0; i < items.size(); i++)
+                    result[i] = items[i].second;
             }
-
-            /**
-             *  Post-increment operator.
-             * @return ---> Copy of this iterator before incrementing.
-             */
-            BaseIterator operator++(int)
+            else
             {
-                BaseIterator temp = *this;
-                ++(*this);
-                return temp;
+                for (size_t i = 0; i < result.size(); i++)
+                    result[i] = i;
+                std::stable_sort(result.begin(), result.end(), [&](size_t a, size_t b)
+                                 { return std::invoke(comp, std::invoke(proj, elements[a]), std::invoke(proj, elements[b])); });
             }
-            /**
-             *  Equality operator.
-             * @param other ---> Another iterator to compare.
-             * @return ---> True if both iterators are at the same position.
-             */
-            bool operator==(const BaseIterator &other) const
+            return result;
+        }
+
+        /**
+         * Per-container modification counter (a plain integer, no shared state between containers).
+         * A container only ever moves to a larger value: assignment jumps past both operands' values and
+         * moving from a container advances it, so an iterator's saved generation never matches again
+         * once the contents it was created for are gone.
+         */
+        struct Generation
+        {
+            std::uint64_t value = 1;
+
+            Generation() = default;
+            Generation(const Generation &other) : value(other.value) {}
+            Generation(Generation &&other) noexcept : value(other.value) { other.value++; }
+
+            Generation &operator=(const Generation &other)
             {
-                return index == other.index;
+                value = std::max(value, other.value) + 1;
+                return *this;
             }
-            /**
-             *  Inequality operator.
-             * @param other --->  Another iterator to compare.
-             * @return --->  True if the iterators are not at the same position.
-             * @throws---->  std::invalid_argument if the iterators belong to different containers.
-             */
-            bool operator!=(const BaseIterator &other) const
+
+            Generation &operator=(Generation &&other) noexcept
             {
-                if (&container != &other.container)
-                {
-                    throw std::invalid_argument("Cannot compare iterators from different containers");
-                }
-                return index != other.index;
+                value = std::max(value, other.value) + 1;
+                other.value++;
+                return *this;
             }
         };
 
         /**
-         * @class ---> AscendingIterator
-         * Iterator that traverses elements of MyContainer in ascending order.
-         * Constructs a sorted view of the container's elements from smallest to largest.
-         * If constructed with 'end=true', points to one past the last element.
+         * Caches that const members of MyContainer build lazily: the sorted representation, the scratch of
+         * the last quickselect and the tracked extremes. Concurrent const readers share one mutex, and the
+         * sorted representation is published through an atomic generation so that readers finding it
+         * valid do not lock. Copies and moves lock the source, so copying a container that other threads
+         * are reading is safe too; each copy gets its own mutex.
          */
-
-        class AscendingIterator : public BaseIterator
+        template <typename T>
+        struct LazyCaches
         {
-        public:
-            AscendingIterator(const MyContainer &contain, bool end = false) : BaseIterator(contain, contain.elements)
+            std::vector<size_t> sorted_index; //< Stable ascending permutation of the elements.
+            std::vector<T> sorted_cache;      //< The elements in ascending order.
+            std::atomic<std::uint64_t> sorted_generation{0};
+            std::vector<size_t> selection; //< Scratch of the last quickselect (see nth_smallest).
+            size_t selected = 0;           //< Position selected by the last quickselect.
+            std::uint64_t selection_generation = 0;
+            std::optional<T> min_cache, max_cache;
+            bool min_dirty = true, max_dirty = true;
+            mutable std::mutex mutex;
+
+            LazyCaches() = default;
+            LazyCaches(const LazyCaches &other)
             {
-                if (contain.elements.empty())
+                std::lock_guard<std::mutex> lock(other.mutex);
+                assign(other);
+            }
+            LazyCaches(LazyCaches &&other) noexcept
+            {
+                std::lock_guard<std::mutex> lock(other.mutex);
+                assign(std::move(other));
+            }
+
+            LazyCaches &operator=(const LazyCaches &other)
+            {
+                if (this != &other)
                 {
-                    if (end)
-                        this->index = 0;
-                    return;
+                    std::scoped_lock lock(mutex, other.mutex);
+                    assign(other);
                 }
+                return *this;
+            }
 
-                for (size_t i = 0; i < this->order.size(); i++)
+            LazyCaches &operator=(LazyCaches &&other) noexcept
+            {
+                if (this != &other)
                 {
-                    for (size_t j = 0; j < this->order.size() - 1 - i; j++)
-                        if (this->order[j] > this->order[j + 1])
-                            std::swap(this->order[j], this->order[j + 1]);
+                    std::scoped_lock lock(mutex, other.mutex);
+                    assign(std::move(other));
                 }
-                if (end)
-                    this->index = this->order.size();
+                return *this;
+            }
+
+        private:
+            template <typename Other>
+            void assign(Other &&other)
+            {
+                sorted_index = std::forward<Other>(other).sorted_index;
+                sorted_cache = std::forward<Other>(other).sorted_cache;
+                sorted_generation.store(other.sorted_generation.load(std::memory_order_relaxed), std::memory_order_relaxed);
+                selection = std::forward<Other>(other).selection;
+                selected = other.selected;
+                selection_generation = other.selection_generation;
+                min_cache = std::forward<Other>(other).min_cache;
+                max_cache = std::forward<Other>(other).max_cache;
+                min_dirty = other.min_dirty;
+                max_dirty = other.max_dirty;
             }
-            /**
-             * Returns an AscendingIterator to the beginning of the container.
-             */
-            static AscendingIterator begin(const MyContainer &c) { return AscendingIterator(c); }
-            /**
-             *Returns an AscendingIterator to the beginning of the container.
-             */
-            static AscendingIterator end(const MyContainer &c) { return AscendingIterator(c, true); }
         };
 
         /**
-         * @class ---> DescendingIterator
-         *  Iterator that traverses elements of MyContainer in descending order.
-         * Constructs a sorted view of the container's elements from largest to smallest.
-         * If constructed with 'end=true', points to one past the last element.
+         * Compensated (Kahan-Babuska / Neumaier) sum: keeps the rounding error of every addition in a
+         * second accumulator, so long running sums of floating point values do not drift.
          */
-        class DescendingIterator : public BaseIterator
+        template <typename F>
+        struct CompensatedSum
         {
-        public:
-            DescendingIterator(const MyContainer &contain, bool end = false) : BaseIterator(contain, contain.elements)
+            F sum = 0;
+            F compensation = 0;
+
+            void add(F x)
             {
-                if (contain.elements.empty())
-                {
-                    if (end)
-                        this->index = 0;
-                    return;
-                }
-                for (size_t i = 0; i < this->order.size(); i++)
-                {
-                    for (size_t j = 0; j < this->order.size() - 1 - i; j++)
-                        if (this->order[j] < this->order[j + 1])
-                            std::swap(this->order[j], this->order[j + 1]);
-                }
-                if (end)
-                    this->index = this->order.size();
+                F t = sum + x;
+                if (std::abs(sum) >= std::abs(x))
+                    compensation += (sum - t) + x;
+                else
+                    compensation += (x - t) + sum;
+                sum = t;
             }
-            /**
-             * Returns a DescendingIterator to the beginning of the container.
-             */
-            static DescendingIterator begin(const MyContainer &c) { return DescendingIterator(c); }
-            /**
-             *  Returns a DescendingIterator to the end of the container.
-             */
-            static DescendingIterator end(const MyContainer &c) { return DescendingIterator(c, true); }
+
+            F value() const { return sum + compensation; }
         };
 
         /**
-         * @class ---> SideCrossIterator
-         * Iterator that alternates between the smallest and largest remaining elements.
-         * First yields the smallest, then the largest, then second smallest, second largest, etc.
-         * Useful for symmetric or center-out patterns.
+         * @class ---> BufferedFileWriter
+         * Background file writer used by MyContainer::export_async.
+         * The producer formats the next chunk into its own buffer while the writer thread
+         * flushes the previous one to disk (double buffering), so formatting and writing overlap.
          */
-
-        class SideCrossIterator : public BaseIterator
+        class BufferedFileWriter
         {
+        private:
+            std::ofstream out;
+            std::string pending; //< Chunk handed over to the writer thread.
+            bool has_pending = false;
+            bool done = false;
+            bool failed = false;
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::thread worker;
+
+            void run()
+            {
+                std::string writing;
+                while (true)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        cv.wait(lock, [this]
+                                { return has_pending || done; });
+                        if (!has_pending)
+                            return;
+                        writing.swap(pending);
+                        has_pending = false;
+                    }
+                    cv.notify_all();
+                    if (!out.write(writing.data(), static_cast<std::streamsize>(writing.size())))
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        failed = true;
+                    }
+                    writing.clear();
+                }
+            }
+
         public:
-            SideCrossIterator(const MyContainer &contain, bool end = false) : BaseIterator(contain, {})
+            /**
+             * Opens the output file and starts the writer thread.
+             * @param path ---> The file to create (truncated if it exists).
+             * @throws ---> std::runtime_error if the file cannot be opened.
+             */
+            explicit BufferedFileWriter(const std::string &path) : out(path, std::ios::binary | std::ios::trunc)
             {
-                if (contain.elements.empty())
+                if (!out)
                 {
-                    if (end)
-                        this->index = 0;
-                    return;
+                    throw std::runtime_error("Cannot open export file: " + path);
                 }
+                worker = std::thread(&BufferedFileWriter::run, this);
+            }
 
-                std::vector<T> temp = contain.elements;
-                std::sort(temp.begin(), temp.end());
-                size_t left = 0, right = temp.size() - 1;
-                while (left <= right)
+            BufferedFileWriter(const BufferedFileWriter &) = delete;
+            BufferedFileWriter &operator=(const BufferedFileWriter &) = delete;
+
+            ~BufferedFileWriter()
+            {
+                if (worker.joinable())
                 {
-                    this->order.push_back(temp[left]);
-                    left++;
-                    if (left <= right)
                     {
-                        this->order.push_back(temp[right]);
-                        right--;
+                        std::lock_guard<std::mutex> lock(mutex);
+                        done = true;
                     }
+                    cv.notify_all();
+                    worker.join();
                 }
-                if (end)
-                    this->index = this->order.size();
             }
+
             /**
-             * Returns a SideCrossIterator to the beginning of the container.
+             * Hands a formatted chunk to the writer thread.
+             * Blocks only while the writer is still busy with the chunk before it.
+             * @param chunk ---> The chunk to write. Receives a cleared buffer that can be reused.
              */
-            static SideCrossIterator begin(const MyContainer &c) { return SideCrossIterator(c); }
-            /**
-             * Returns a SideCrossIterator to the end of the container.
+            void submit(std::string &chunk)
+            {
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    cv.wait(lock, [this]
+                            { return !has_pending; });
+                    pending.swap(chunk);
+                    has_pending = true;
+                }
+                cv.notify_all();
+                chunk.clear();
+            }
+
+            /**
+             * Waits until every submitted chunk is on disk and closes the file.
+             * @throws ---> std::runtime_error if a write failed.
              */
-            static SideCrossIterator end(const MyContainer &c) { return SideCrossIterator(c, true); }
+            void finish()
+            {
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    done = true;
+                }
+                cv.notify_all();
+                worker.join();
+                out.close();
+                if (failed || out.fail())
+                {
+                    throw std::runtime_error("Writing the export file failed");
+                }
+            }
         };
+    }
 
+    /**
+     * @class --->  MyContainer
+     *  A templated container class that holds elements and provides multiple iteration strategies.
+     * This container supports dynamic insertion and removal of elements and provides size querying and
+     * printing functionalities. It serves as a basis for various custom iterators implemented as inner classes.
+     * Const members may be called from several threads at once (the caches they build are locked); any
+     * modification needs exclusive access.
+     * @tparam ---> T The type of elements stored in the container. Defaults to int.
+     * @tparam ---> Compare Strict weak ordering used by the value-ordered iterators. Defaults to std::less<>.
+     * @tparam ---> Projection Maps an element to the key that is compared. Defaults to std::identity.
+     * @tparam ---> InlineCapacity Number of elements stored inside the container (and inside every iterator)
+     * without heap allocation. Defaults to 0: all elements on the heap, in a std::vector.
+     */
+    template <typename T = int, typename Compare = std::less<>, typename Projection = std::identity, size_t InlineCapacity = 0> //< Internal storage of elements.
+    class MyContainer
+    {
+    public:
         /**
-         * @class ---> ReverseOrder
-         * Iterator that traverses elements in reverse insertion order.
-         * The last element added is visited first.
+         * Storage of the elements and of the iterator snapshots: a std::vector, or a SmallVector that keeps
+         * the first InlineCapacity elements inside the object.
          */
-        class ReverseOrder : public BaseIterator
+        using storage_type = std::conditional_t<InlineCapacity == 0, std::vector<T>, SmallVector<T, InlineCapacity>>;
+
+    private:
+        storage_type elements;
+        [[no_unique_address]] Compare comp;    //< Orders the projected keys.
+        [[no_unique_address]] Projection proj; //< Extracts the key of an element.
+
+    public:
+        /**
+         * Type returned by sum(): T for floating point types, a 64-bit integer for integral types.
+         */
+        using sum_type = std::conditional_t<std::is_floating_point_v<T>, T,
+                                            std::conditional_t<std::is_signed_v<T>, long long, unsigned long long>>;
+        /**
+         * Type returned by mean() and variance().
+         */
+        using stat_type = std::conditional_t<std::is_same_v<T, long double>, long double, double>;
+        /**
+         * Type of the keys compared by the value orders (the result of Projection).
+         */
+        using key_type = std::remove_cvref_t<std::invoke_result_t<const Projection &, const T &>>;
+        using value_type = T;
+
+    private:
+        bool unordered = false; //< Positional removal swaps with the last element (see unordered_removal).
+        // Aggregate tracking (see track_aggregates). The extremes are recomputed lazily after the
+        // current one is removed; the moments are kept around a shift (the first element) for stability.
+        bool tracking = false;
+        sum_type running_sum{};
+        detail::CompensatedSum<stat_type> float_sum, shifted, shifted_sq;
+        stat_type shift{};
+
+        /**
+         * Updates the tracked aggregates after val was appended.
+         */
+        void on_insert(const T &val)
         {
-        public:
-            ReverseOrder(const MyContainer &contain, bool end = false) : BaseIterator(contain, {})
+            bump_generation();
+            if (!tracking)
+                return;
+            if (elements.size() == 1)
             {
-                if (contain.elements.empty())
-                {
-                    if (end)
-                        this->index = 0;
-                    return;
-                }
-                const std::vector<T> &temp = contain.elements;
-                for (auto iterator = temp.rbegin(); iterator != temp.rend(); iterator++)
-                    this->order.push_back(*iterator);
-                if (end)
-                    this->index = this->order.size();
+                reset_aggregates();
+                return;
             }
+            if (!caches.min_dirty && (!caches.min_cache || std::invoke(comp, std::invoke(proj, val), std::invoke(proj, *caches.min_cache))))
+                caches.min_cache = val;
+            if (!caches.max_dirty && (!caches.max_cache || !std::invoke(comp, std::invoke(proj, val), std::invoke(proj, *caches.max_cache))))
+                caches.max_cache = val;
+            if constexpr (std::is_arithmetic_v<T>)
+                add_moments(val, 1);
+        }
 
-            /**
-             * Returns a ReverseOrder iterator to the beginning of the container (last inserted element).
-             */
-            static ReverseOrder begin(const MyContainer &c) { return ReverseOrder(c); }
+        /**
+         * Updates the tracked aggregates after `copies` elements equal to val were removed.
+         * A cached extreme is dropped when its key is equivalent to val's, so T needs no operator==.
+         */
+        void on_erase(const T &val, size_t copies)
+        {
+            bump_generation();
+            if (!tracking)
+                return;
+            if (elements.empty())
+            {
+                reset_aggregates();
+                return;
+            }
+            auto equivalent = [this, &val](const T &cached)
+            {
+                const auto &a = std::invoke(proj, cached);
+                const auto &b = std::invoke(proj, val);
+                return !std::invoke(comp, a, b) && !std::invoke(comp, b, a);
+            };
+            if (!caches.min_dirty && caches.min_cache && equivalent(*caches.min_cache))
+                caches.min_dirty = true;
+            if (!caches.max_dirty && caches.max_cache && equivalent(*caches.max_cache))
+                caches.max_dirty = true;
+            if constexpr (std::is_arithmetic_v<T>)
+                for (size_t i = 0; i < copies; i++)
+                    add_moments(val, -1);
+        }
 
-            /**
-             * Returns a ReverseOrder iterator to the end of the container.
-             */
-            static ReverseOrder end(const MyContainer &c) { return ReverseOrder(c, true); }
-        };
+        void add_moments(const T &val, int sign)
+        {
+            if constexpr (std::is_floating_point_v<T>)
+                float_sum.add(sign * val);
+            else if (sign > 0)
+                running_sum += static_cast<sum_type>(val);
+            else
+                running_sum -= static_cast<sum_type>(val);
+            stat_type d = static_cast<stat_type>(val) - shift;
+            shifted.add(sign * d);
+            shifted_sq.add(sign * d * d);
+        }
 
         /**
-         * @class ---> Order
-         * Iterator that preserves the insertion order of elements.
-         * Elements are visited in the same sequence they were added.
+         * Restarts the tracking from the current elements (O(n)).
          */
+        void reset_aggregates()
+        {
+            caches.min_cache.reset();
+            caches.max_cache.reset();
+            caches.min_dirty = caches.max_dirty = !elements.empty();
+            running_sum = sum_type{};
+            float_sum = shifted = shifted_sq = detail::CompensatedSum<stat_type>();
+            if constexpr (std::is_arithmetic_v<T>)
+            {
+                shift = elements.empty() ? stat_type{} : static_cast<stat_type>(elements.front());
+                for (const T &val : elements)
+                    add_moments(val, 1);
+            }
+        }
 
-        class Order : public BaseIterator
+        /**
+         * First smallest (extreme = false) or last largest (extreme = true) element, matching the first
+         * element of the ascending and descending traversals.
+         */
+        const T &scan_extreme(bool largest) const
         {
-        public:
-            Order(const MyContainer &contain, bool end = false) : BaseIterator(contain, contain.elements)
+            const T *best = &elements.front();
+            for (const T &val : elements)
             {
-                if (end)
-                    this->index = this->order.size();
+                if (largest ? !std::invoke(comp, std::invoke(proj, val), std::invoke(proj, *best))
+                            : std::invoke(comp, std::invoke(proj, val), std::invoke(proj, *best)))
+                    best = &val;
             }
-            /**
-             * Returns an Order iterator to the beginning of the container.
-             */
+            return *best;
+        }
 
-            static Order begin(const MyContainer &c) { return Order(c); }
-            /**
-             * Returns an Order iterator to the end of the container.
-             */
-            static Order end(const MyContainer &c) { return Order(c, true); }
-        };
+        // Every modification moves the container to a new generation. The caches below remember the
+        // generation they were built for and are valid only while it is current.
+        detail::Generation current_generation;
+        // Sorted representation, quickselect scratch and tracked extremes, built on demand by const members.
+        mutable detail::LazyCaches<T> caches;
 
         /**
-         * @class ---> MiddleOutOrder
-         * Iterator that starts from the middle element and expands outward.
-         * For even sizes, starts from left-middle. Then alternates left/right.
+         * Moves the container to a new generation, which invalidates the caches and the iterators.
          */
+        void bump_generation()
+        {
+            current_generation.value++;
+        }
 
-        class MiddleOutOrder : public BaseIterator
+        bool sorted_valid() const { return caches.sorted_generation.load(std::memory_order_acquire) == current_generation.value; }
+        bool selection_valid() const { return caches.selection_generation == current_generation.value; } //< Needs caches.mutex.
+
+        /**
+         * Builds the sorted representation if needed.
+         */
+        void ensure_sorted() const
         {
-        public:
-            MiddleOutOrder(const MyContainer &contain, bool end = false) : BaseIterator(contain, {})
+            if (sorted_valid())
+                return;
+            std::lock_guard<std::mutex> lock(caches.mutex);
+            build_sorted();
+        }
+
+        /**
+         * Builds the sorted representation if no other reader did it meanwhile. Needs caches.mutex.
+         */
+        void build_sorted() const
+        {
+            if (sorted_valid())
+                return;
+            caches.sorted_index = detail::sorted_permutation(elements, comp, proj);
+            caches.sorted_cache.clear();
+            caches.sorted_cache.reserve(elements.size());
+            for (size_t i : caches.sorted_index)
+                caches.sorted_cache.push_back(elements[i]);
+            caches.sorted_generation.store(current_generation.value, std::memory_order_release);
+        }
+
+        /**
+         * Returns the cached stable ascending permutation.
+         */
+        const std::vector<size_t> &sorted_permutation() const
+        {
+            ensure_sorted();
+            return caches.sorted_index;
+        }
+
+        /**
+         * Returns a copy of the elements sorted from smallest to largest key (stable), from the cache.
+         * A container that fits in its inline capacity is instead sorted directly in the (inline) copy
+         * by a stable insertion sort, so its sorted traversals make no heap allocation.
+         */
+        storage_type sorted_elements() const
+        {
+            if constexpr (InlineCapacity > 0)
             {
-                const std::vector<T> &temp = contain.elements;
-                if (temp.empty())
-                {
-                    if (end)
-                        this->index = 0;
-                    return;
-                }
-                if (temp.size() == 0)
-                    return;
-                size_t middle = temp.size() / 2;
-                if (temp.size() % 2 == 0)
-                    middle--;
-                this->order.push_back(temp[middle]);
-                size_t left = middle;
-                size_t right = middle + 1;
-                while (left > 0 || right < temp.size())
+                if (elements.size() <= InlineCapacity && !sorted_valid())
                 {
-                    if (left > 0)
-                    {
-                        left--;
-                        this->order.push_back(temp[left]);
-                    }
-                    if (right < temp.size())
+                    storage_type sorted = elements;
+                    for (size_t i = 1; i < sorted.size(); i++)
                     {
-                        this->order.push_back(temp[right]);
-                        right++;
+                        T current = std::move(sorted[i]);
+                        size_t j = i;
+                        while (j > 0 && std::invoke(comp, std::invoke(proj, current), std::invoke(proj, sorted[j - 1])))
+                        {
+                            sorted[j] = std::move(sorted[j - 1]);
+                            j--;
+                        }
+                        sorted[j] = std::move(current);
                     }
+                    return sorted;
                 }
-                if (end)
-                    this->index = this->order.size();
             }
-            /**
-             * Returns a MiddleOutOrder iterator to the beginning of the container.
-             */
-            static MiddleOutOrder begin(const MyContainer &c) { return MiddleOutOrder(c); }
-            /**
-             * Returns a MiddleOutOrder iterator to the end of the container.
-             */
-            static MiddleOutOrder end(const MyContainer &c) { return MiddleOutOrder(c, true); }
-        };
+            ensure_sorted();
+            return storage_type(caches.sorted_cache.begin(), caches.sorted_cache.end());
+        }
+
+    public:
         /**
-         * Returns an AscendingIterator to the beginning.
+         * Creates an empty container.
+         * @param compare ---> The comparator of the projected keys.
+         * @param projection ---> The key extractor.
          */
-        AscendingIterator begin_ascending_order() const { return AscendingIterator(*this); }
+        explicit MyContainer(Compare compare = Compare(), Projection projection = Projection())
+            : comp(std::move(compare)), proj(std::move(projection)) {}
+
         /**
-         * Returns an AscendingIterator to the end.
+         *  Adds an element to the container.
+         * @param val ---> The element to be added.
          */
-        AscendingIterator end_ascending_order() const { return AscendingIterator(*this, true); }
+        void addElement(const T &val)
+        {
+            elements.push_back(val);
+            on_insert(val);
+        }
+
         /**
-         * Returns a DescendingIterator to the beginning.
+         * Removes all occurrences of an element from the container, in one pass.
+         * @param val ---> The element to be removed.
+         * @throws ---> std::invalid_argument if the element is not found (see remove_first and remove_if
+         * for removals that do not throw).
          */
+        void removeElement(const T &val)
+        {
+            auto original_size = elements.size();
+            if constexpr (simd::is_vectorizable_v<T>)
+                elements.erase(elements.begin() + static_cast<std::ptrdiff_t>(simd::remove(elements.data(), elements.size(), val)), elements.end());
+            else
+                elements.erase(std::remove(elements.begin(), elements.end(), val), elements.end());
+            if (elements.size() == original_size)
+            {
+                throw std::invalid_argument("Element not found in container");
+            }
+            on_erase(val, original_size - elements.size());
+        }
 
-        DescendingIterator begin_descending_order() const { return DescendingIterator(*this); }
         /**
-         * Returns a DescendingIterator to the end.
+         * Removes every element that satisfies a predicate, in a single compacting pass that keeps the
+         * order of the remaining elements.
+         * @param pred ---> Called once per element with a const reference; true removes the element.
+         * @return ---> The number of removed elements (0 is not an error).
          */
-        DescendingIterator end_descending_order() const { return DescendingIterator(*this, true); }
+        template <typename Predicate>
+        size_t remove_if(Predicate pred)
+        {
+            auto original_size = elements.size();
+            elements.erase(std::remove_if(elements.begin(), elements.end(), [&pred](const T &val)
+                                          { return static_cast<bool>(std::invoke(pred, val)); }),
+                           elements.end());
+            size_t removed = original_size - elements.size();
+            if (removed > 0)
+            {
+                bump_generation();
+                if (tracking)
+                    reset_aggregates();
+            }
+            return removed;
+        }
+
         /**
-         * Returns a SideCrossIterator to the beginning.
+         * Removes the first occurrence of an element (in insertion order), stopping the search at it.
+         * The removal itself is that of erase_at.
+         * @param val ---> The element to be removed.
+         * @return ---> False if the element is not found.
          */
+        bool remove_first(const T &val)
+        {
+            auto found = std::find(elements.begin(), elements.end(), val);
+            if (found == elements.end())
+                return false;
+            erase_at(static_cast<size_t>(found - elements.begin()));
+            return true;
+        }
 
-        SideCrossIterator begin_side_cross_order() const { return SideCrossIterator(*this); }
         /**
-         * Returns a SideCrossIterator to the end.
+         * Removes the element at a position of the insertion order.
+         * By default the following elements shift down (O(n - index)), so the insertion order is kept.
+         * With unordered_removal() the last element is moved into the gap instead, in O(1).
+         * @param index ---> The position in the insertion order.
+         * @throws ---> std::out_of_range if index >= size().
          */
-        SideCrossIterator end_side_cross_order() const { return SideCrossIterator(*this, true); }
+        void erase_at(size_t index)
+        {
+            if (index >= elements.size())
+            {
+                throw std::out_of_range("Erase index out of range");
+            }
+            T val = std::move(elements[index]);
+            if (unordered)
+            {
+                if (index + 1 != elements.size())
+                    elements[index] = std::move(elements.back());
+                elements.pop_back();
+            }
+            else
+                elements.erase(elements.begin() + static_cast<std::ptrdiff_t>(index), elements.begin() + static_cast<std::ptrdiff_t>(index + 1));
+            on_erase(val, 1);
+        }
+
         /**
-         * Returns a ReverseOrder iterator to the beginning.
+         * Turns the unordered removal mode on or off. While it is on, erase_at and erase remove an element
+         * in O(1) by moving the last element into its place: the insertion, reverse and middle-out orders no
+         * longer follow the order of addition, while the value orders stay exact (equal keys are then ordered
+         * by their current positions). removeElement is not affected.
+         * @param enable ---> True for swap-and-pop removal, false to keep the insertion order (the default).
          */
+        void unordered_removal(bool enable = true)
+        {
+            unordered = enable;
+        }
 
-        ReverseOrder begin_reverse_order() const { return ReverseOrder(*this); }
         /**
-         * Returns a ReverseOrder iterator to the end.
+         * Turns incremental aggregate tracking on or off.
+         * While it is on, addElement updates min, max, sum and the moments in O(1), and removeElement only marks
+         * an extreme for recomputation when it removes that extreme, so the queries below are O(1) except for the
+         * first min()/max() after such a removal. While it is off the queries scan the elements (still no sort).
+         * @param enable ---> True to start tracking (computed once from the current elements), false to stop.
          */
-        ReverseOrder end_reverse_order() const { return ReverseOrder(*this, true); }
+        void track_aggregates(bool enable = true)
+        {
+            tracking = enable;
+            if (enable)
+                reset_aggregates();
+        }
+
         /**
-         * Returns an Order iterator to the beginning.
+         * Returns the smallest element (the first element of the ascending traversal).
+         * @throws ---> std::out_of_range if the container is empty.
          */
+        T min() const
+        {
+            if (elements.empty())
+            {
+                throw std::out_of_range("Container is empty");
+            }
+            if (!tracking)
+                return scan_extreme(false);
+            std::lock_guard<std::mutex> lock(caches.mutex);
+            if (caches.min_dirty)
+            {
+                caches.min_cache = scan_extreme(false);
+                caches.min_dirty = false;
+            }
+            return *caches.min_cache;
+        }
 
-        Order begin_order() const { return Order(*this); }
         /**
-         * Returns an Order iterator to the end.
+         * Returns the largest element (the first element of the descending traversal).
+         * @throws ---> std::out_of_range if the container is empty.
          */
-        Order end_order() const { return Order(*this, true); }
+        T max() const
+        {
+            if (elements.empty())
+            {
+                throw std::out_of_range("Container is empty");
+            }
+            if (!tracking)
+                return scan_extreme(true);
+            std::lock_guard<std::mutex> lock(caches.mutex);
+            if (caches.max_dirty)
+            {
+                caches.max_cache = scan_extreme(true);
+                caches.max_dirty = false;
+            }
+            return *caches.max_cache;
+        }
+
         /**
-         * Returns a MiddleOutOrder iterator to the beginning.
+         * Returns the sum of the elements (0 for an empty container). Floating point sums are compensated.
          */
+        sum_type sum() const
+            requires std::is_arithmetic_v<T>
+        {
+            if constexpr (std::is_floating_point_v<T>)
+            {
+                if (tracking)
+                    return static_cast<sum_type>(float_sum.value());
+                detail::CompensatedSum<stat_type> total;
+                for (const T &val : elements)
+                    total.add(val);
+                return static_cast<sum_type>(total.value());
+            }
+            else
+            {
+                if (tracking)
+                    return running_sum;
+                sum_type total{};
+                for (const T &val : elements)
+                    total += static_cast<sum_type>(val);
+                return total;
+            }
+        }
 
-        MiddleOutOrder begin_middle_out_order() const { return MiddleOutOrder(*this); }
         /**
-         * Returns a MiddleOutOrder iterator to the end.
+         * Returns the arithmetic mean of the elements.
+         * @throws ---> std::out_of_range if the container is empty.
          */
+        stat_type mean() const
+            requires std::is_arithmetic_v<T>
+        {
+            if (elements.empty())
+            {
+                throw std::out_of_range("Container is empty");
+            }
+            return static_cast<stat_type>(sum()) / static_cast<stat_type>(elements.size());
+        }
 
-        MiddleOutOrder end_middle_out_order() const { return MiddleOutOrder(*this, true); }
-    };
+        /**
+         * Returns the population variance of the elements (divided by n).
+         * @throws ---> std::out_of_range if the container is empty.
+         */
+        stat_type variance() const
+            requires std::is_arithmetic_v<T>
+        {
+            if (elements.empty())
+            {
+                throw std::out_of_range("Container is empty");
+            }
+            stat_type n = static_cast<stat_type>(elements.size());
+            if (tracking)
+            {
+                stat_type s1 = shifted.value(), s2 = shifted_sq.value();
+                return std::max(stat_type{}, (s2 - s1 * s1 / n) / n);
+            }
+            stat_type m = mean();
+            detail::CompensatedSum<stat_type> squares;
+            for (const T &val : elements)
+            {
+                stat_type d = static_cast<stat_type>(val) - m;
+                squares.add(d * d);
+            }
+            return squares.value() / n;
+        }
 
-#endif
-}
+        /**
+         * Returns true if the sorted representation is cached, so sorted_view() and the ordered lookups
+         * are answered without sorting.
+         */
+        bool has_sorted_view() const { return sorted_valid(); }
+
+        /**
+         * Returns the elements in ascending order as a zero-copy view of the cached sorted representation.
+         * The first call after a modification sorts (O(n log n)); later calls are O(1).
+         * The view is valid until the next modification of the container.
+         */
+        std::span<const T> sorted_view() const
+        {
+            ensure_sorted();
+            return std::span<const T>(caches.sorted_cache);
+        }
+
+        /**
+         * Returns the k-th smallest element (0-based), i.e. the element at position k of the ascending traversal.
+         * With a cached sorted representation this is O(1). Otherwise the first query runs a quickselect
+         * (std::nth_element, O(n)) on a scratch permutation; asking for the same k again is O(1), and asking
+         * for another k on the unchanged container sorts once so that all further queries are O(1).
+         * @param k ---> The rank, smaller than size().
+         * @throws ---> std::out_of_range if k >= size().
+         */
+        T nth_smallest(size_t k) const
+        {
+            if (k >= elements.size())
+            {
+                throw std::out_of_range("Order statistic index out of range");
+            }
+            if (sorted_valid())
+                return caches.sorted_cache[k];
+            std::lock_guard<std::mutex> lock(caches.mutex);
+            if (selection_valid() && caches.selected == k)
+                return elements[caches.selection[k]];
+            if (selection_valid() || sorted_valid())
+            {
+                build_sorted();
+                return caches.sorted_cache[k];
+            }
+            caches.selection.resize(elements.size());
+            for (size_t i = 0; i < caches.selection.size(); i++)
+                caches.selection[i] = i;
+            std::nth_element(caches.selection.begin(), caches.selection.begin() + static_cast<std::ptrdiff_t>(k), caches.selection.end(),
+                             [this](size_t a, size_t b)
+                             {
+                                 const auto &ka = std::invoke(proj, elements[a]);
+                                 const auto &kb = std::invoke(proj, elements[b]);
+                                 if (std::invoke(comp, ka, kb))
+                                     return true;
+                                 return !std::invoke(comp, kb, ka) && a < b;
+                             });
+            caches.selected = k;
+            caches.selection_generation = current_generation.value;
+            return elements[caches.selection[k]];
+        }
+
+        /**
+         * Returns the (lower) median: the element at position (size() - 1) / 2 of the ascending traversal.
+         * @throws ---> std::out_of_range if the container is empty.
+         */
+        T median() const
+        {
+            if (elements.empty())
+            {
+                throw std::out_of_range("Container is empty");
+            }
+            return nth_smallest((elements.size() - 1) / 2);
+        }
+
+        /**
+         * Returns the q-quantile using the nearest-rank method: the element at position ceil(q * n) - 1
+         * of the ascending traversal (position 0 for q = 0). For example quantile(0.99) is the p99.
+         * @param q ---> The quantile, between 0 and 1.
+         * @throws ---> std::invalid_argument if q is outside [0, 1], std::out_of_range if the container is empty.
+         */
+        T quantile(double q) const
+        {
+            if (!(q >= 0.0 && q <= 1.0))
+            {
+                throw std::invalid_argument("Quantile must be between 0 and 1");
+            }
+            if (elements.empty())
+            {
+                throw std::out_of_range("Container is empty");
+            }
+            size_t rank = static_cast<size_t>(std::ceil(q * static_cast<double>(elements.size())));
+            return nth_smallest(rank == 0 ? 0 : std::min(rank, elements.size()) - 1);
+        }
+
+        /**
+         * Checks whether an element is in the container, without copying it.
+         * Arithmetic types are compared a full vector register at a time (see SimdKernels.hpp).
+         * @param val ---> The element to look for.
+         * @return ---> True if at least one element equals val.
+         */
+        bool contains(const T &val) const
+        {
+            if constexpr (simd::is_vectorizable_v<T>)
+                return simd::contains(elements.data(), elements.size(), val);
+            else
+                return std::find(elements.begin(), elements.end(), val) != elements.end();
+        }
+
+        /**
+         * Counts the occurrences of an element, without copying the container.
+         * Arithmetic types are compared a full vector register at a time (see SimdKernels.hpp).
+         * @param val ---> The element to count.
+         * @return ---> The number of elements equal to val.
+         */
+        size_t count(const T &val) const
+        {
+            if constexpr (simd::is_vectorizable_v<T>)
+                return simd::count(elements.data(), elements.size(), val);
+            else
+                return static_cast<size_t>(std::count(elements.begin(), elements.end(), val));
+        }
+        /**
+         *  Returns the number of elements currently in the container.
+         * @return ---> The size of the container.
+         */
+        size_t size() const
+        {
+            return elements.size();
+        }
+
+        /**
+         * Returns the current generation. It changes on every modification of the container
+         * (and on assignment), so it can be compared to tell whether the contents changed.
+         */
+        std::uint64_t generation() const
+        {
+            return current_generation.value;
+        }
+
+        /**
+         * Returns the comparator of the keys.
+         */
+        const Compare &key_comp() const { return comp; }
+
+        /**
+         * Returns the projection that extracts the key of an element.
+         */
+        const Projection &projection() const { return proj; }
+
+        /**
+         *  Prints all elements in the container to the output stream.
+         * @param os ---> The output stream.
+         * @param container ---> The container to print.
+         * @return ---> A reference to the output stream.
+         */
+        friend std::ostream &operator<<(std::ostream &os, const MyContainer &container)
+        {
+            for (auto iterator = container.elements.begin(); iterator != container.elements.end(); iterator++)
+                os << *iterator << " ";
+            return os;
+        }
+
+        /**
+         * @class BaseIterator
+         *  base class for iterators over MyContainer.
+         * This class provides common logic for all iterators such as element access,
+         * increment, and comparison operations. Each derived iterator defines its own traversal order.
+         * An iterator remembers the container generation it was created at, and erase rejects it once the
+         * container was modified. When ARIEL_CHECKED_ITERATORS is defined, dereferencing or comparing such
+         * an iterator throws std::logic_error as well; without it that check compiles away.
+         */
+
+        class BaseIterator
+        {
+            friend class MyContainer;
+
+        protected:
+            const MyContainer &container; //< Reference to the container being iterated.
+            storage_type order;              //< Ordered list of elements to iterate over.
+            size_t index;                    //< Current index in the iteration.
+            TraversalOrder traversal;        //< The order of the snapshot (maps a position back to an element).
+            std::uint64_t generation;        //< Container generation at construction.
+
+            /**
+             * Checked builds: throws std::logic_error if the container was modified since construction.
+             */
+            void check_generation() const
+            {
+#ifdef ARIEL_CHECKED_ITERATORS
+                if (generation != container.generation())
+                {
+                    throw std::logic_error("Iterator used after its container was modified");
+                }
+#endif
+            }
+
+        public:
+            /**
+             *  Constructs a BaseIterator with a given container and order.
+             * @param contain ---> The container to iterate.
+             * @param vec ---> The traversal order of elements.
+             * @param o ---> The traversal order that vec follows.
+             */
+            BaseIterator(const MyContainer &contain, storage_type vec, TraversalOrder o)
+                : container(contain), order(std::move(vec)), index(0), traversal(o), generation(contain.generation())
+            {
+            }
+
+            /**
+             * Dereference operator to access current element.
+             * @return ---> The current element.
+             * @throws --->  std::out_of_range if the index is beyond the end.
+             */
+            T operator*() const
+            {
+                check_generation();
+                if (index >= order.size())
+                {
+                    throw std::out_of_range("Dereferencing past-the-end iterator");
+                }
+                return order.at(index);
+            }
+
+            /**
+             *  Pre-increment operator.
+             * @return ---> Reference to this iterator after incrementing.
+             */
+            BaseIterator &operator++()
+            {
+                index++;
+                return *this;
+            }
+
+            /**
+             *  Post-increment operator.
+             * @return ---> Copy of this iterator before incrementing.
+             */
+            BaseIterator operator++(int)
+            {
+                BaseIterator temp = *this;
+                ++(*this);
+                return temp;
+            }
+
+            /**
+             * Copies the next elements into a caller buffer and advances past them.
+             * @param out ---> Destination; at most out.size() elements are copied.
+             * @return ---> The number of elements copied (0 at the end).
+             */
+            size_t next_batch(std::span<T> out)
+            {
+                std::span<const T> next = next_span(out.size());
+                std::copy(next.begin(), next.end(), out.begin());
+                return next.size();
+            }
+
+            /**
+             * Returns the next elements as a zero-copy view of the iterator's traversal and advances past them.
+             * The view stays valid as long as this iterator exists.
+             * @param max ---> Largest number of elements in the view.
+             * @return ---> A view of at most max elements (empty at the end).
+             */
+            std::span<const T> next_span(size_t max)
+            {
+                check_generation();
+                size_t start = std::min(index, order.size());
+                size_t count = std::min(max, order.size() - start);
+                index = start + count;
+                return std::span<const T>(order.data() + start, count);
+            }
+            /**
+             *  Equality operator.
+             * @param other ---> Another iterator to compare.
+             * @return ---> True if both iterators are at the same position.
+             */
+            bool operator==(const BaseIterator &other) const
+            {
+                check_generation();
+                other.check_generation();
+                return index == other.index;
+            }
+            /**
+             *  Inequality operator.
+             * @param other --->  Another iterator to compare.
+             * @return --->  True if the iterators are not at the same position.
+             * @throws---->  std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator!=(const BaseIterator &other) const
+            {
+                if (&container != &other.container)
+                {
+                    throw std::invalid_argument("Cannot compare iterators from different containers");
+                }
+                check_generation();
+                other.check_generation();
+                return index != other.index;
+            }
+        };
+
+        /**
+         * @class ---> AscendingIterator
+         * Iterator that traverses elements of MyContainer in ascending order.
+         * Constructs a sorted view of the container's elements from smallest to largest.
+         * If constructed with 'end=true', points to one past the last element.
+         */
+
+        class AscendingIterator : public BaseIterator
+        {
+        public:
+            AscendingIterator(const MyContainer &contain, bool end = false) : BaseIterator(contain, contain.sorted_elements(), TraversalOrder::Ascending)
+            {
+                if (end)
+                    this->index = this->order.size();
+            }
+            /**
+             * Returns an AscendingIterator to the beginning of the container.
+             */
+            static AscendingIterator begin(const MyContainer &c) { return AscendingIterator(c); }
+            /**
+             *Returns an AscendingIterator to the beginning of the container.
+             */
+            static AscendingIterator end(const MyContainer &c) { return AscendingIterator(c, true); }
+        };
+
+        /**
+         * @class ---> DescendingIterator
+         *  Iterator that traverses elements of MyContainer in descending order.
+         * Constructs a sorted view of the container's elements from largest to smallest.
+         * It is the exact reverse of AscendingIterator, so elements with equal keys appear in reverse insertion order.
+         * If constructed with 'end=true', points to one past the last element.
+         */
+        class DescendingIterator : public BaseIterator
+        {
+        public:
+            DescendingIterator(const MyContainer &contain, bool end = false) : BaseIterator(contain, contain.sorted_elements(), TraversalOrder::Descending)
+            {
+                std::reverse(this->order.begin(), this->order.end());
+                if (end)
+                    this->index = this->order.size();
+            }
+            /**
+             * Returns a DescendingIterator to the beginning of the container.
+             */
+            static DescendingIterator begin(const MyContainer &c) { return DescendingIterator(c); }
+            /**
+             *  Returns a DescendingIterator to the end of the container.
+             */
+            static DescendingIterator end(const MyContainer &c) { return DescendingIterator(c, true); }
+        };
+
+        /**
+         * @class ---> SideCrossIterator
+         * Iterator that alternates between the smallest and largest remaining elements.
+         * First yields the smallest, then the largest, then second smallest, second largest, etc.
+         * Useful for symmetric or center-out patterns.
+         */
+
+        class SideCrossIterator : public BaseIterator
+        {
+        public:
+            SideCrossIterator(const MyContainer &contain, bool end = false) : BaseIterator(contain, {}, TraversalOrder::SideCross)
+            {
+                if (contain.elements.empty())
+                {
+                    if (end)
+                        this->index = 0;
+                    return;
+                }
+
+                storage_type temp = contain.sorted_elements();
+                size_t left = 0, right = temp.size() - 1;
+                while (left <= right)
+                {
+                    this->order.push_back(temp[left]);
+                    left++;
+                    if (left <= right)
+                    {
+                        this->order.push_back(temp[right]);
+                        right--;
+                    }
+                }
+                if (end)
+                    this->index = this->order.size();
+            }
+            /**
+             * Returns a SideCrossIterator to the beginning of the container.
+             */
+            static SideCrossIterator begin(const MyContainer &c) { return SideCrossIterator(c); }
+            /**
+             * Returns a SideCrossIterator to the end of the container.
+             */
+            static SideCrossIterator end(const MyContainer &c) { return SideCrossIterator(c, true); }
+        };
+
+        /**
+         * @class ---> ReverseOrder
+         * Iterator that traverses elements in reverse insertion order.
+         * The last element added is visited first.
+         */
+        class ReverseOrder : public BaseIterator
+        {
+        public:
+            ReverseOrder(const MyContainer &contain, bool end = false) : BaseIterator(contain, {}, TraversalOrder::Reverse)
+            {
+                if (contain.elements.empty())
+                {
+                    if (end)
+                        this->index = 0;
+                    return;
+                }
+                const storage_type &temp = contain.elements;
+                for (auto iterator = temp.rbegin(); iterator != temp.rend(); iterator++)
+                    this->order.push_back(*iterator);
+                if (end)
+                    this->index = this->order.size();
+            }
+
+            /**
+             * Returns a ReverseOrder iterator to the beginning of the container (last inserted element).
+             */
+            static ReverseOrder begin(const MyContainer &c) { return ReverseOrder(c); }
+
+            /**
+             * Returns a ReverseOrder iterator to the end of the container.
+             */
+            static ReverseOrder end(const MyContainer &c) { return ReverseOrder(c, true); }
+        };
+
+        /**
+         * @class ---> Order
+         * Iterator that preserves the insertion order of elements.
+         * Elements are visited in the same sequence they were added.
+         */
+
+        class Order : public BaseIterator
+        {
+        public:
+            Order(const MyContainer &contain, bool end = false) : BaseIterator(contain, contain.elements, TraversalOrder::Insertion)
+            {
+                if (end)
+                    this->index = this->order.size();
+            }
+            /**
+             * Returns an Order iterator to the beginning of the container.
+             */
+
+            static Order begin(const MyContainer &c) { return Order(c); }
+            /**
+             * Returns an Order iterator to the end of the container.
+             */
+            static Order end(const MyContainer &c) { return Order(c, true); }
+        };
+
+        /**
+         * @class ---> MiddleOutOrder
+         * Iterator that starts from the middle element and expands outward.
+         * For even sizes, starts from left-middle. Then alternates left/right.
+         */
+
+        class MiddleOutOrder : public BaseIterator
+        {
+        public:
+            MiddleOutOrder(const MyContainer &contain, bool end = false) : BaseIterator(contain, {}, TraversalOrder::MiddleOut)
+            {
+                const storage_type &temp = contain.elements;
+                if (temp.empty())
+                {
+                    if (end)
+                        this->index = 0;
+                    return;
+                }
+                if (temp.size() == 0)
+                    return;
+                size_t middle = temp.size() / 2;
+                if (temp.size() % 2 == 0)
+                    middle--;
+                this->order.push_back(temp[middle]);
+                size_t left = middle;
+                size_t right = middle + 1;
+                while (left > 0 || right < temp.size())
+                {
+                    if (left > 0)
+                    {
+                        left--;
+                        this->order.push_back(temp[left]);
+                    }
+                    if (right < temp.size())
+                    {
+                        this->order.push_back(temp[right]);
+                        right++;
+                    }
+                }
+                if (end)
+                    this->index = this->order.size();
+            }
+            /**
+             * Returns a MiddleOutOrder iterator to the beginning of the container.
+             */
+            static MiddleOutOrder begin(const MyContainer &c) { return MiddleOutOrder(c); }
+            /**
+             * Returns a MiddleOutOrder iterator to the end of the container.
+             */
+            static MiddleOutOrder end(const MyContainer &c) { return MiddleOutOrder(c, true); }
+        };
+        /**
+         * Returns an AscendingIterator to the beginning.
+         */
+        AscendingIterator begin_ascending_order() const { return AscendingIterator(*this); }
+        /**
+         * Returns an AscendingIterator to the end.
+         */
+        AscendingIterator end_ascending_order() const { return AscendingIterator(*this, true); }
+        /**
+         * Returns a DescendingIterator to the beginning.
+         */
+
+        DescendingIterator begin_descending_order() const { return DescendingIterator(*this); }
+        /**
+         * Returns a DescendingIterator to the end.
+         */
+        DescendingIterator end_descending_order() const { return DescendingIterator(*this, true); }
+        /**
+         * Returns a SideCrossIterator to the beginning.
+         */
+
+        SideCrossIterator begin_side_cross_order() const { return SideCrossIterator(*this); }
+        /**
+         * Returns a SideCrossIterator to the end.
+         */
+        SideCrossIterator end_side_cross_order() const { return SideCrossIterator(*this, true); }
+        /**
+         * Returns a ReverseOrder iterator to the beginning.
+         */
+
+        ReverseOrder begin_reverse_order() const { return ReverseOrder(*this); }
+        /**
+         * Returns a ReverseOrder iterator to the end.
+         */
+        ReverseOrder end_reverse_order() const { return ReverseOrder(*this, true); }
+        /**
+         * Returns an Order iterator to the beginning.
+         */
+
+        Order begin_order() const { return Order(*this); }
+        /**
+         * Returns an Order iterator to the end.
+         */
+        Order end_order() const { return Order(*this, true); }
+        /**
+         * Returns a MiddleOutOrder iterator to the beginning.
+         */
+
+        MiddleOutOrder begin_middle_out_order() const { return MiddleOutOrder(*this); }
+        /**
+         * Returns a MiddleOutOrder iterator to the end.
+         */
+
+        MiddleOutOrder end_middle_out_order() const { return MiddleOutOrder(*this, true); }
+
+        /**
+         * @class ---> ValueRange
+         * The elements whose keys lie in a closed interval, in ascending or descending order
+         * (see ascending_range and descending_range). When the container had a cached sorted
+         * representation the range is a view of a slice of it, otherwise it owns the matching elements.
+         * A view is valid until the next modification of the container (checked builds throw
+         * std::logic_error when a stale view is dereferenced, see BaseIterator).
+         */
+        class ValueRange
+        {
+        private:
+            std::shared_ptr<const std::vector<T>> owned; //< Matching elements, when they were filtered out of unsorted storage.
+            std::span<const T> slice;                    //< The matching elements in ascending order.
+            bool reversed;                               //< True for descending_range.
+#ifdef ARIEL_CHECKED_ITERATORS
+            const MyContainer *source; //< Container whose cache is viewed (null when owned).
+            std::uint64_t generation;  //< Its generation at construction.
+#endif
+
+            void check_generation() const
+            {
+#ifdef ARIEL_CHECKED_ITERATORS
+                if (source && generation != source->generation())
+                {
+                    throw std::logic_error("Range used after its container was modified");
+                }
+#endif
+            }
+
+        public:
+            ValueRange(const MyContainer &contain, std::span<const T> s, std::shared_ptr<const std::vector<T>> o, bool r)
+                : owned(std::move(o)), slice(s), reversed(r)
+            {
+#ifdef ARIEL_CHECKED_ITERATORS
+                source = owned ? nullptr : &contain;
+                generation = contain.generation();
+#else
+                (void)contain;
+#endif
+            }
+
+            /**
+             * @class ---> Iterator
+             * Forward iterator over the range.
+             */
+            class Iterator
+            {
+            private:
+                const ValueRange *range;
+                size_t index;
+
+            public:
+                Iterator(const ValueRange &r, size_t i) : range(&r), index(i) {}
+
+                /**
+                 * @throws ---> std::out_of_range if the index is beyond the end.
+                 */
+                const T &operator*() const
+                {
+                    range->check_generation();
+                    size_t n = range->slice.size();
+                    if (index >= n)
+                    {
+                        throw std::out_of_range("Dereferencing past-the-end iterator");
+                    }
+                    return range->slice[range->reversed ? n - 1 - index : index];
+                }
+
+                Iterator &operator++()
+                {
+                    index++;
+                    return *this;
+                }
+
+                Iterator operator++(int)
+                {
+                    Iterator temp = *this;
+                    ++(*this);
+                    return temp;
+                }
+
+                bool operator==(const Iterator &other) const { return index == other.index; }
+
+                /**
+                 * @throws---->  std::invalid_argument if the iterators belong to different ranges.
+                 */
+                bool operator!=(const Iterator &other) const
+                {
+                    if (range != other.range)
+                    {
+                        throw std::invalid_argument("Cannot compare iterators from different ranges");
+                    }
+                    return index != other.index;
+                }
+            };
+
+            Iterator begin() const { return Iterator(*this, 0); }
+            Iterator end() const { return Iterator(*this, slice.size()); }
+            size_t size() const { return slice.size(); }
+            bool empty() const { return slice.empty(); }
+        };
+
+        /**
+         * Returns the elements whose keys k satisfy lo <= k <= hi (in the order of Compare), in ascending order.
+         * With a cached sorted representation the endpoints are found by binary search and the range is a
+         * zero-copy slice: O(log n) plus the iteration. Otherwise the matching elements are filtered out in
+         * one O(n) pass and only they are sorted, the rest of the container is never sorted.
+         * Equal keys keep the stable order of the ascending traversal.
+         * @param lo ---> Smallest key in the range.
+         * @param hi ---> Largest key in the range. An empty range is returned if hi < lo.
+         */
+        ValueRange ascending_range(const key_type &lo, const key_type &hi) const
+        {
+            return value_range(lo, hi, false);
+        }
+
+        /**
+         * Returns the elements whose keys k satisfy lo <= k <= hi, in descending order: the exact reverse of
+         * ascending_range(lo, hi), with the same cost.
+         * @param hi ---> Largest key in the range (visited first).
+         * @param lo ---> Smallest key in the range.
+         */
+        ValueRange descending_range(const key_type &hi, const key_type &lo) const
+        {
+            return value_range(lo, hi, true);
+        }
+
+        /**
+         * Returns the number of elements whose key is smaller than key: the position an element with this
+         * key would take in the ascending traversal (before its equals).
+         * O(log n) on the cached sorted representation (the first query after a modification sorts).
+         */
+        size_t rank(const key_type &key) const
+        {
+            return lower_position(key);
+        }
+
+        /**
+         * Returns the largest element whose key is smaller than key, if any. O(log n), see rank.
+         */
+        std::optional<T> predecessor(const key_type &key) const
+        {
+            size_t pos = lower_position(key);
+            if (pos == 0)
+                return std::nullopt;
+            return caches.sorted_cache[pos - 1];
+        }
+
+        /**
+         * Returns the smallest element whose key is larger than key, if any. O(log n), see rank.
+         */
+        std::optional<T> successor(const key_type &key) const
+        {
+            size_t pos = upper_position(key);
+            if (pos == caches.sorted_cache.size())
+                return std::nullopt;
+            return caches.sorted_cache[pos];
+        }
+
+        /**
+         * Returns the number of elements whose keys k satisfy lo <= k <= hi (0 if hi < lo). O(log n), see rank.
+         */
+        size_t count_between(const key_type &lo, const key_type &hi) const
+        {
+            if (std::invoke(comp, hi, lo))
+                return 0;
+            return upper_position(hi) - lower_position(lo);
+        }
+
+        /**
+         * Returns an AscendingIterator positioned at the first element whose key is not smaller than key
+         * (the end iterator if there is none). The position is found in O(log n); constructing the iterator
+         * copies the sorted elements like begin_ascending_order().
+         */
+        AscendingIterator lower_bound(const key_type &key) const
+        {
+            AscendingIterator it(*this);
+            it.index = lower_position(key);
+            return it;
+        }
+
+        /**
+         * Returns an AscendingIterator positioned at the first element whose key is larger than key
+         * (the end iterator if there is none). See lower_bound.
+         */
+        AscendingIterator upper_bound(const key_type &key) const
+        {
+            AscendingIterator it(*this);
+            it.index = upper_position(key);
+            return it;
+        }
+
+        /**
+         * Removes the element an iterator of this container points at (see erase_at for the cost and the
+         * unordered mode). The position is mapped back to the element in O(1), after building the sorted
+         * representation if a value order needs it. Every iterator of the container is invalidated.
+         * @param it ---> An iterator of any traversal order, created after the last modification.
+         * @throws ---> std::invalid_argument if the iterator belongs to another container,
+         * std::out_of_range if it is past the end, std::logic_error if the container was modified after
+         * the iterator was created (in every build).
+         */
+        void erase(const BaseIterator &it)
+        {
+            if (&it.container != this)
+            {
+                throw std::invalid_argument("Cannot erase through an iterator of another container");
+            }
+            if (it.generation != current_generation.value)
+            {
+                throw std::logic_error("Iterator used after its container was modified");
+            }
+            if (it.index >= it.order.size())
+            {
+                throw std::out_of_range("Erasing through a past-the-end iterator");
+            }
+            const size_t *sorted = detail::is_value_order(it.traversal) ? sorted_permutation().data() : nullptr;
+            erase_at(detail::traversal_index(it.traversal, elements.size(), it.index, sorted));
+        }
+
+        /**
+         * Writes the elements to a file in the given traversal order, without blocking the caller.
+         * The container is copied before returning; order generation, formatting (in chunks) and
+         * writing then run as a pipeline on background threads, so a large export is limited by
+         * the disk rather than by the sum of the three stages.
+         * Later changes to the container do not affect an export that is already running.
+         * @param path ---> The file to create.
+         * @param order ---> The traversal order to export.
+         * @param format ---> How every element is written.
+         * @return ---> A future holding the number of exported elements. Errors (for example an
+         * unwritable path) are reported as std::runtime_error through the future.
+         * @throws ---> std::invalid_argument if Binary is requested for a non trivially copyable T.
+         */
+        std::future<size_t> export_async(const std::string &path, TraversalOrder order = TraversalOrder::Ascending,
+                                         ExportFormat format = ExportFormat::Text) const
+        {
+            if (format == ExportFormat::Binary && !std::is_trivially_copyable_v<T>)
+            {
+                throw std::invalid_argument("Binary export requires a trivially copyable element type");
+            }
+            return std::async(std::launch::async, [snapshot = MyContainer(*this), path, order, format]()
+                              { return snapshot.write_to(path, order, format); });
+        }
+
+        /**
+         * Calls fn on every element of a traversal order, in parallel on the shared WorkStealingPool.
+         * The order is split into ranges of positions; since the element at any position can be computed
+         * directly (see detail::traversal_index), every range starts in the middle of the sequence without
+         * walking the positions before it. The value orders sort once, before the work is split.
+         * fn may be called concurrently and in any order, and the container must not be modified meanwhile.
+         * @param order ---> The traversal order.
+         * @param fn ---> Called as fn(const T &) once per element.
+         * @param grain ---> Largest number of consecutive positions handled as one task.
+         * @throws ---> The first exception thrown by fn.
+         */
+        template <typename Fn>
+        void parallel_for_each(TraversalOrder order, Fn fn, size_t grain = 1024) const
+        {
+            size_t n = elements.size();
+            const size_t *sorted = detail::is_value_order(order) ? sorted_permutation().data() : nullptr;
+            WorkStealingPool::instance().parallel_for(0, n, grain, [&](size_t lo, size_t hi)
+                                                      {
+                for (size_t pos = lo; pos < hi; pos++)
+                    fn(elements[detail::traversal_index(order, n, pos, sorted)]); });
+        }
+
+        /**
+         * Ordered parallel reduction over a traversal order.
+         * The positions are cut into chunks of `grain`; every chunk is folded in parallel with
+         * combine(acc, map(x)), then the chunk results are combined from left to right after init.
+         * combine must be associative but does not have to be commutative: the result equals
+         * the sequential fold over the traversal.
+         * @param order ---> The traversal order.
+         * @param init ---> The initial value (left-most operand).
+         * @param map ---> Called as map(const T &), returns R.
+         * @param combine ---> Called as combine(R, R), returns R.
+         * @param grain ---> Number of positions per chunk.
+         * @return ---> The reduced value (init for an empty container).
+         */
+        template <typename R, typename Map, typename Combine>
+        R parallel_reduce(TraversalOrder order, R init, Map map, Combine combine, size_t grain = 1024) const
+        {
+            size_t n = elements.size();
+            grain = std::max<size_t>(1, grain);
+            const size_t *sorted = detail::is_value_order(order) ? sorted_permutation().data() : nullptr;
+            size_t chunks = (n + grain - 1) / grain;
+            std::vector<std::optional<R>> partial(chunks);
+            WorkStealingPool::instance().parallel_for(0, chunks, 1, [&](size_t lo, size_t hi)
+                                                      {
+                for (size_t c = lo; c < hi; c++)
+                {
+                    size_t first = c * grain, last = std::min(n, first + grain);
+                    R acc = map(elements[detail::traversal_index(order, n, first, sorted)]);
+                    for (size_t pos = first + 1; pos < last; pos++)
+                        acc = combine(std::move(acc), map(elements[detail::traversal_index(order, n, pos, sorted)]));
+                    partial[c] = std::move(acc);
+                } });
+            for (auto &value : partial)
+                init = combine(std::move(init), std::move(*value));
+            return init;
+        }
+
+        /**
+         * Hands the elements of a traversal order to fn in consecutive chunks, for batch (SIMD) consumers.
+         * Insertion order is passed as zero-copy views of the storage and ascending order as zero-copy views of
+         * the cached sorted representation. The other orders are gathered chunk by
+         * chunk into one reusable buffer (a reversed copy, a gather through the sorted permutation, or a gather
+         * through the computed positions), so the full traversal is never materialized.
+         * @param order ---> The traversal order.
+         * @param chunk_size ---> Number of elements per chunk (the last one may be shorter).
+         * @param fn ---> Called as fn(std::span<const T>) for every chunk. The view is only valid during the call.
+         * @throws ---> std::invalid_argument if chunk_size is 0.
+         */
+        template <typename Fn>
+        void for_each_chunk(TraversalOrder order, size_t chunk_size, Fn fn) const
+        {
+            if (chunk_size == 0)
+            {
+                throw std::invalid_argument("Chunk size must be positive");
+            }
+            size_t n = elements.size();
+            if (order == TraversalOrder::Insertion || order == TraversalOrder::Ascending)
+            {
+                const T *data = (order == TraversalOrder::Insertion) ? elements.data() : sorted_view().data();
+                for (size_t lo = 0; lo < n; lo += chunk_size)
+                    fn(std::span<const T>(data + lo, std::min(chunk_size, n - lo)));
+                return;
+            }
+            const size_t *sorted = detail::is_value_order(order) ? sorted_permutation().data() : nullptr;
+            std::vector<T> buffer(std::min(chunk_size, n));
+            for (size_t lo = 0; lo < n; lo += chunk_size)
+            {
+                size_t count = std::min(chunk_size, n - lo);
+                gather(order, lo, count, sorted, buffer.data());
+                fn(std::span<const T>(buffer.data(), count));
+            }
+        }
+
+        /**
+         * Returns a lazy generator over a traversal order. Nothing is computed until the first element is
+         * requested, and no copy of the elements is made:
+         * - positional orders compute the index of every element when it is requested;
+         * - value orders keep a binary heap of indices (built in O(n)) and pop one element per request in
+         *   O(log n), so taking the first k elements costs O(n + k log n) instead of a full sort.
+         *   SideCross pops from a min-heap and a max-heap alternately.
+         * The sequence equals the corresponding iterator's, equal keys included.
+         * The container must outlive the generator and must not be modified while it is in use (checked
+         * builds throw std::logic_error from the generator, see BaseIterator).
+         * @param order ---> The traversal order.
+         */
+        Generator<T> generate(TraversalOrder order) const
+        {
+            size_t n = elements.size();
+#ifdef ARIEL_CHECKED_ITERATORS
+            std::uint64_t generation = current_generation.value;
+            auto check = [this, generation]
+            {
+                if (generation != current_generation.value)
+                {
+                    throw std::logic_error("Generator used after its container was modified");
+                }
+            };
+#else
+            auto check = [] {};
+#endif
+            if (!detail::is_value_order(order))
+            {
+                for (size_t pos = 0; pos < n; pos++)
+                {
+                    check();
+                    co_yield elements[detail::traversal_index(order, n, pos, nullptr)];
+                }
+                co_return;
+            }
+            // before(a, b): element a comes before element b in the (stable) ascending traversal.
+            auto before = [this](size_t a, size_t b)
+            {
+                const auto &ka = std::invoke(proj, elements[a]);
+                const auto &kb = std::invoke(proj, elements[b]);
+                if (std::invoke(comp, ka, kb))
+                    return true;
+                return !std::invoke(comp, kb, ka) && a < b;
+            };
+            auto after = [&before](size_t a, size_t b)
+            { return before(b, a); };
+            std::vector<size_t> low, high; //< Heaps with the next smallest / largest element on top.
+            if (order != TraversalOrder::Descending)
+            {
+                low.resize(n);
+                for (size_t i = 0; i < n; i++)
+                    low[i] = i;
+                std::make_heap(low.begin(), low.end(), after);
+            }
+            if (order != TraversalOrder::Ascending)
+            {
+                high.resize(n);
+                for (size_t i = 0; i < n; i++)
+                    high[i] = i;
+                std::make_heap(high.begin(), high.end(), before);
+            }
+            for (size_t pos = 0; pos < n; pos++)
+            {
+                check();
+                size_t next;
+                if (order == TraversalOrder::Ascending || (order == TraversalOrder::SideCross && pos % 2 == 0))
+                {
+                    std::pop_heap(low.begin(), low.end(), after);
+                    next = low.back();
+                    low.pop_back();
+                }
+                else
+                {
+                    std::pop_heap(high.begin(), high.end(), before);
+                    next = high.back();
+                    high.pop_back();
+                }
+                co_yield elements[next];
+            }
+        }
+
+        /**
+         * Returns a lazy generator over the distinct keys in ascending order: for every group of equivalent
+         * keys, the element that comes first in the ascending traversal. See grouped_ascending.
+         */
+        Generator<T> distinct_ascending() const
+        {
+            for (const auto &group : grouped_ascending())
+                co_yield group.first;
+        }
+
+        /**
+         * Returns a lazy generator of (element, count) pairs in ascending order, one for every group of
+         * equivalent keys; the element is the first of the group in the ascending traversal.
+         * With a cached sorted representation the groups are runs of the sorted view, read in place.
+         * Otherwise natural-ordered hashable keys are counted in a hash table in one pass and only the
+         * distinct keys are sorted (O(n + d log d)); when the keys turn out to be mostly distinct the
+         * sorted representation is built instead. Other keys always use the sorted representation.
+         * The container must outlive the generator and must not be modified while it is in use.
+         */
+        Generator<std::pair<T, size_t>> grouped_ascending() const
+        {
+#ifdef ARIEL_CHECKED_ITERATORS
+            std::uint64_t generation = current_generation.value;
+            auto check = [this, generation]
+            {
+                if (generation != current_generation.value)
+                {
+                    throw std::logic_error("Generator used after its container was modified");
+                }
+            };
+#else
+            auto check = [] {};
+#endif
+            if (!sorted_valid())
+            {
+                if (auto groups = counted_groups())
+                {
+                    for (auto [first, copies] : *groups)
+                    {
+                        check();
+                        co_yield std::pair<T, size_t>(elements[first], copies);
+                    }
+                    co_return;
+                }
+                ensure_sorted();
+            }
+            size_t n = caches.sorted_cache.size();
+            for (size_t start = 0; start < n;)
+            {
+                check();
+                size_t end = start + 1;
+                while (end < n && !std::invoke(comp, std::invoke(proj, caches.sorted_cache[start]), std::invoke(proj, caches.sorted_cache[end])))
+                    end++;
+                co_yield std::pair<T, size_t>(caches.sorted_cache[start], end - start);
+                start = end;
+            }
+        }
+
+    private:
+        /**
+         * Groups the elements by counting their keys in a hash table: (index of the first element, count)
+         * for every distinct key, in ascending key order. Returns std::nullopt if the keys cannot be hashed
+         * or are not compared by their natural order, and gives up as soon as too many keys are distinct
+         * (see detail::DISTINCT_HASH_RATIO; sorting everything is then cheaper).
+         */
+        std::optional<std::vector<std::pair<size_t, size_t>>> counted_groups() const
+        {
+            if constexpr (detail::is_natural_order_v<Compare> && detail::is_hashable<key_type>::value)
+            {
+                size_t limit = elements.size() / detail::DISTINCT_HASH_RATIO;
+                std::unordered_map<key_type, size_t> group_of; //< Key -> position in groups.
+                std::vector<std::pair<size_t, size_t>> groups;
+                for (size_t i = 0; i < elements.size(); i++)
+                {
+                    auto [found, added] = group_of.try_emplace(std::invoke(proj, elements[i]), groups.size());
+                    if (added)
+                    {
+                        if (groups.size() == limit)
+                            return std::nullopt;
+                        groups.emplace_back(i, 0);
+                    }
+                    groups[found->second].second++;
+                }
+                std::sort(groups.begin(), groups.end(), [this](const auto &a, const auto &b)
+                          { return std::invoke(comp, std::invoke(proj, elements[a.first]), std::invoke(proj, elements[b.first])); });
+                return groups;
+            }
+            return std::nullopt;
+        }
+
+        /**
+         * Position of the first element of the sorted cache whose key is not smaller than key.
+         */
+        size_t lower_position(const key_type &key) const
+        {
+            ensure_sorted();
+            auto found = std::lower_bound(caches.sorted_cache.begin(), caches.sorted_cache.end(), key, [this](const T &e, const key_type &k)
+                                          { return std::invoke(comp, std::invoke(proj, e), k); });
+            return static_cast<size_t>(found - caches.sorted_cache.begin());
+        }
+
+        /**
+         * Position of the first element of the sorted cache whose key is larger than key.
+         */
+        size_t upper_position(const key_type &key) const
+        {
+            ensure_sorted();
+            auto found = std::upper_bound(caches.sorted_cache.begin(), caches.sorted_cache.end(), key, [this](const key_type &k, const T &e)
+                                          { return std::invoke(comp, k, std::invoke(proj, e)); });
+            return static_cast<size_t>(found - caches.sorted_cache.begin());
+        }
+
+        /**
+         * Builds the range of ascending_range / descending_range.
+         */
+        ValueRange value_range(const key_type &lo, const key_type &hi, bool reversed) const
+        {
+            if (std::invoke(comp, hi, lo))
+                return ValueRange(*this, {}, nullptr, reversed);
+            if (sorted_valid())
+            {
+                auto first = std::lower_bound(caches.sorted_cache.begin(), caches.sorted_cache.end(), lo, [this](const T &e, const key_type &k)
+                                              { return std::invoke(comp, std::invoke(proj, e), k); });
+                auto last = std::upper_bound(first, caches.sorted_cache.end(), hi, [this](const key_type &k, const T &e)
+                                             { return std::invoke(comp, k, std::invoke(proj, e)); });
+                return ValueRange(*this, std::span<const T>(first, last), nullptr, reversed);
+            }
+            std::vector<T> matching;
+            for (const T &e : elements)
+            {
+                const auto &k = std::invoke(proj, e);
+                if (!std::invoke(comp, k, lo) && !std::invoke(comp, hi, k))
+                    matching.push_back(e);
+            }
+            auto sorted = std::make_shared<std::vector<T>>();
+            sorted->reserve(matching.size());
+            for (size_t i : detail::sorted_permutation(matching, comp, proj))
+                sorted->push_back(std::move(matching[i]));
+            std::span<const T> slice(*sorted);
+            return ValueRange(*this, slice, std::move(sorted), reversed);
+        }
+
+        static constexpr size_t EXPORT_CHUNK = 4096; //< Elements formatted per chunk handed to the writer.
+
+        /**
+         * Copies the elements at positions [lo, lo + count) of a traversal order into out.
+         * Every order has its own simple loop so the compiler can vectorize the copy or gather.
+         */
+        void gather(TraversalOrder order, size_t lo, size_t count, const size_t *sorted, T *out) const
+        {
+            size_t n = elements.size();
+            const T *data = elements.data();
+            switch (order)
+            {
+            case TraversalOrder::Reverse:
+                std::reverse_copy(data + (n - lo - count), data + (n - lo), out);
+                break;
+            case TraversalOrder::Ascending:
+                for (size_t j = 0; j < count; j++)
+                    out[j] = data[sorted[lo + j]];
+                break;
+            case TraversalOrder::Descending:
+                for (size_t j = 0; j < count; j++)
+                    out[j] = data[sorted[n - 1 - lo - j]];
+                break;
+            default:
+                for (size_t j = 0; j < count; j++)
+                    out[j] = data[detail::traversal_index(order, n, lo + j, sorted)];
+                break;
+            }
+        }
+
+        /**
+         * Calls fn on every element in the given traversal order.
+         */
+        template <typename Fn>
+        void traverse(TraversalOrder order, Fn &&fn) const
+        {
+            switch (order)
+            {
+            case TraversalOrder::Ascending:
+                visit(begin_ascending_order(), fn);
+                break;
+            case TraversalOrder::Descending:
+                visit(begin_descending_order(), fn);
+                break;
+            case TraversalOrder::SideCross:
+                visit(begin_side_cross_order(), fn);
+                break;
+            case TraversalOrder::Reverse:
+                visit(begin_reverse_order(), fn);
+                break;
+            case TraversalOrder::Insertion:
+                visit(begin_order(), fn);
+                break;
+            case TraversalOrder::MiddleOut:
+                visit(begin_middle_out_order(), fn);
+                break;
+            }
+        }
+
+        /**
+         * Walks size() elements from the given begin iterator (no end iterator has to be built).
+         */
+        template <typename Iterator, typename Fn>
+        void visit(Iterator it, Fn &fn) const
+        {
+            for (size_t i = 0; i < elements.size(); ++i, ++it)
+                fn(*it);
+        }
+
+        /**
+         * Body of export_async: formats the traversal chunk by chunk and hands every chunk to a
+         * BufferedFileWriter, which writes it while the next one is being formatted.
+         */
+        size_t write_to(const std::string &path, TraversalOrder order, ExportFormat format) const
+        {
+            detail::BufferedFileWriter writer(path);
+            std::ostringstream chunk;
+            std::string buffer;
+            size_t in_chunk = 0;
+            traverse(order, [&](const T &val)
+                     {
+                if (format == ExportFormat::Binary)
+                {
+                    if constexpr (std::is_trivially_copyable_v<T>)
+                        chunk.write(reinterpret_cast<const char *>(&val), sizeof(T));
+                }
+                else
+                    chunk << val << (format == ExportFormat::Lines ? '\n' : ' ');
+                if (++in_chunk == EXPORT_CHUNK)
+                {
+                    buffer = chunk.str();
+                    chunk.str(std::string());
+                    writer.submit(buffer);
+                    in_chunk = 0;
+                } });
+            buffer = chunk.str();
+            if (!buffer.empty())
+                writer.submit(buffer);
+            writer.finish();
+            return elements.size();
+        }
+    };
+
+    namespace detail
+    {
+        /**
+         * Tournament tree of losers over k sources. Internal node t (1 <= t < k) keeps the loser of the
+         * match played there and node 0 the overall winner; source i is the leaf k + i. After the winner
+         * advances, only its path to the root is replayed: log2(k) comparisons per element.
+         * better(a, b) must tell whether the current head of source a goes before that of source b
+         * (an exhausted source never goes before another one).
+         */
+        template <typename Better>
+        class LoserTree
+        {
+        private:
+            std::vector<size_t> tree;
+            size_t k;
+            Better better;
+
+            /**
+             * Plays the matches of the subtree rooted at node t and returns its winner.
+             */
+            size_t build(size_t t)
+            {
+                if (t >= k)
+                    return t - k;
+                size_t left = build(2 * t), right = build(2 * t + 1);
+                bool left_wins = better(left, right);
+                tree[t] = left_wins ? right : left;
+                return left_wins ? left : right;
+            }
+
+        public:
+            LoserTree(size_t sources, Better b) : tree(std::max<size_t>(sources, 1)), k(sources), better(std::move(b))
+            {
+                if (k > 0)
+                    tree[0] = build(1);
+            }
+
+            /**
+             * Returns the source whose head goes first.
+             */
+            size_t winner() const { return tree[0]; }
+
+            /**
+             * Replays the path of the winner after its head has advanced.
+             */
+            void replay()
+            {
+                size_t w = tree[0];
+                for (size_t t = (w + k) / 2; t > 0; t /= 2)
+                    if (better(tree[t], w))
+                        std::swap(tree[t], w);
+                tree[0] = w;
+            }
+        };
+
+        /**
+         * Body of merge_ascending / merge_descending.
+         */
+        template <typename Container>
+        Generator<typename Container::value_type> merge_sorted(std::vector<const Container *> containers, bool descending)
+        {
+            using T = typename Container::value_type;
+            size_t k = containers.size();
+            if (k == 0)
+                co_return;
+            const auto &comp = containers[0]->key_comp();
+            const auto &proj = containers[0]->projection();
+            std::vector<std::span<const T>> views;
+            std::vector<size_t> taken(k, 0);
+            for (const Container *c : containers)
+                views.push_back(c->sorted_view());
+#ifdef ARIEL_CHECKED_ITERATORS
+            std::vector<std::uint64_t> generations;
+            for (const Container *c : containers)
+                generations.push_back(c->generation());
+#endif
+            // Head of source i: the next element from its small end (ascending) or large end (descending).
+            auto head = [&](size_t i) -> const T &
+            {
+                return descending ? views[i][views[i].size() - 1 - taken[i]] : views[i][taken[i]];
+            };
+            auto better = [&](size_t a, size_t b)
+            {
+                if (taken[a] == views[a].size())
+                    return false;
+                if (taken[b] == views[b].size())
+                    return true;
+                const auto &ka = std::invoke(proj, head(a));
+                const auto &kb = std::invoke(proj, head(b));
+                if (descending)
+                    return std::invoke(comp, kb, ka) || (!std::invoke(comp, ka, kb) && a > b);
+                return std::invoke(comp, ka, kb) || (!std::invoke(comp, kb, ka) && a < b);
+            };
+            LoserTree<decltype(better)> tree(k, better);
+            size_t total = 0;
+            for (const auto &view : views)
+                total += view.size();
+            for (size_t i = 0; i < total; i++)
+            {
+#ifdef ARIEL_CHECKED_ITERATORS
+                for (size_t c = 0; c < k; c++)
+                    if (generations[c] != containers[c]->generation())
+                    {
+                        throw std::logic_error("Merge used after a container was modified");
+                    }
+#endif
+                size_t w = tree.winner();
+                const T &val = head(w);
+                taken[w]++;
+                tree.replay();
+                co_yield val;
+            }
+        }
+    }
+
+    /**
+     * Lazily merges several containers into one ascending sequence, without copying them into one container.
+     * Every container contributes its cached sorted view (sorted once, if it was not sorted yet) and a
+     * loser tree picks the next element: O(total * log k) comparisons for k containers.
+     * Equal keys come in container order, then in each container's ascending order, so the result equals
+     * the ascending traversal of the concatenation. The key order of the first container is used.
+     * The containers must outlive the generator and must not be modified while it is in use.
+     * @param containers ---> The containers to merge.
+     */
+    template <typename Container>
+    Generator<typename Container::value_type> merge_ascending(const std::vector<const Container *> &containers)
+    {
+        return detail::merge_sorted(containers, false);
+    }
+
+    template <typename Container, typename... Rest>
+    Generator<typename Container::value_type> merge_ascending(const Container &first, const Rest &...rest)
+    {
+        return detail::merge_sorted(std::vector<const Container *>{&first, &rest...}, false);
+    }
+
+    /**
+     * Lazily merges several containers into one descending sequence: the exact reverse of merge_ascending.
+     */
+    template <typename Container>
+    Generator<typename Container::value_type> merge_descending(const std::vector<const Container *> &containers)
+    {
+        return detail::merge_sorted(containers, true);
+    }
+
+    template <typename Container, typename... Rest>
+    Generator<typename Container::value_type> merge_descending(const Container &first, const Rest &...rest)
+    {
+        return detail::merge_sorted(std::vector<const Container *>{&first, &rest...}, true);
+    }
+
+    namespace detail
+    {
+        enum class SetOperation
+        {
+            Union,
+            Intersection,
+            Difference,
+            SymmetricDifference
+        };
+
+        /**
+         * Largest size of the smaller operand for which unsorted operands are combined by hashing.
+         */
+        inline constexpr size_t HASH_JOIN_MAX = 4096;
+
+        /**
+         * Returns the first position in [from, n) whose element does not go before x, searching with
+         * exponentially growing steps first: O(log d) comparisons for a distance d.
+         */
+        template <typename T, typename Less>
+        size_t gallop(std::span<const T> v, size_t from, const T &x, const Less &less)
+        {
+            size_t lo = from, hi = from, step = 1;
+            while (hi < v.size() && less(v[hi], x))
+            {
+                lo = hi + 1;
+                hi = from + step;
+                step *= 2;
+            }
+            hi = std::min(hi, v.size());
+            return static_cast<size_t>(std::partition_point(v.begin() + static_cast<std::ptrdiff_t>(lo), v.begin() + static_cast<std::ptrdiff_t>(hi),
+                                                            [&](const T &e)
+                                                            { return less(e, x); }) -
+                                       v.begin());
+        }
+
+        /**
+         * Multiset operation on two containers, by key equivalence (the multiplicities of a key in the
+         * result are max, min, difference and absolute difference of those in a and b, as in std::set_union
+         * and friends; elements of a are preferred over equivalent elements of b).
+         * Two unsorted operands of natural-ordered hashable keys, the smaller one with at most HASH_JOIN_MAX
+         * elements, are combined with a hash join in O(n + m). Otherwise both sorted views are merged with
+         * galloping: runs that belong to one side only are skipped or copied after an exponential search,
+         * so a small operand against a large one costs O(n log(m / n)) comparisons instead of O(n + m).
+         */
+        template <typename Container>
+        Container set_operation(const Container &a, const Container &b, SetOperation op)
+        {
+            using T = typename Container::value_type;
+            using Key = typename Container::key_type;
+            const auto &comp = a.key_comp();
+            const auto &proj = a.projection();
+            Container result(comp, proj);
+            bool keep_a_only = op != SetOperation::Intersection;
+            bool keep_b_only = op == SetOperation::Union || op == SetOperation::SymmetricDifference;
+            bool keep_pairs = op == SetOperation::Union || op == SetOperation::Intersection;
+
+            if constexpr (is_natural_order_v<std::remove_cvref_t<decltype(comp)>> && is_hashable<Key>::value)
+            {
+                if (!a.has_sorted_view() && !b.has_sorted_view() && std::min(a.size(), b.size()) <= HASH_JOIN_MAX)
+                {
+                    auto each = [](const Container &c, auto fn)
+                    {
+                        c.for_each_chunk(TraversalOrder::Insertion, HASH_JOIN_MAX, [&](std::span<const T> chunk)
+                                         { for (const T &val : chunk) fn(val); });
+                    };
+                    std::unordered_map<Key, size_t> unpaired; //< Copies of a key in b not paired with a copy in a yet.
+                    std::unordered_map<Key, size_t> paired;   //< Copies of a key in b paired with a copy in a.
+                    each(b, [&](const T &val)
+                         { unpaired[std::invoke(proj, val)]++; });
+                    each(a, [&](const T &val)
+                         {
+                        auto found = unpaired.find(std::invoke(proj, val));
+                        bool match = found != unpaired.end() && found->second > 0;
+                        if (match)
+                        {
+                            found->second--;
+                            paired[found->first]++;
+                        }
+                        if (match ? keep_pairs : keep_a_only)
+                            result.addElement(val); });
+                    if (keep_b_only)
+                        each(b, [&](const T &val)
+                             {
+                            auto found = paired.find(std::invoke(proj, val));
+                            if (found != paired.end() && found->second > 0)
+                                found->second--;
+                            else
+                                result.addElement(val); });
+                    return result;
+                }
+            }
+
+            auto less = [&](const T &x, const T &y)
+            { return std::invoke(comp, std::invoke(proj, x), std::invoke(proj, y)); };
+            std::span<const T> va = a.sorted_view(), vb = b.sorted_view();
+            size_t i = 0, j = 0;
+            while (i < va.size() && j < vb.size())
+            {
+                if (less(va[i], vb[j]))
+                {
+                    size_t end = gallop(va, i, vb[j], less);
+                    if (keep_a_only)
+                        for (; i < end; i++)
+                            result.addElement(va[i]);
+                    i = end;
+                }
+                else if (less(vb[j], va[i]))
+                {
+                    size_t end = gallop(vb, j, va[i], less);
+                    if (keep_b_only)
+                        for (; j < end; j++)
+                            result.addElement(vb[j]);
+                    j = end;
+                }
+                else
+                {
+                    if (keep_pairs)
+                        result.addElement(va[i]);
+                    i++;
+                    j++;
+                }
+            }
+            if (keep_a_only)
+                for (; i < va.size(); i++)
+                    result.addElement(va[i]);
+            if (keep_b_only)
+                for (; j < vb.size(); j++)
+                    result.addElement(vb[j]);
+            return result;
+        }
+    }
+
+    /**
+     * Returns a new container with the multiset union of a and b: every key as many times as in the
+     * operand where it occurs most (see detail::set_operation for the algorithms). The insertion order
+     * of the result is ascending when the operands were merged and unspecified after a hash join.
+     * The key order of a is used.
+     */
+    template <typename T, typename Compare, typename Projection, size_t N>
+    MyContainer<T, Compare, Projection, N> set_union(const MyContainer<T, Compare, Projection, N> &a, const MyContainer<T, Compare, Projection, N> &b)
+    {
+        return detail::set_operation(a, b, detail::SetOperation::Union);
+    }
+
+    /**
+     * Returns a new container with the multiset intersection of a and b: every key as many times as in
+     * the operand where it occurs least, taking the elements of a. See set_union.
+     */
+    template <typename T, typename Compare, typename Projection, size_t N>
+    MyContainer<T, Compare, Projection, N> set_intersection(const MyContainer<T, Compare, Projection, N> &a, const MyContainer<T, Compare, Projection, N> &b)
+    {
+        return detail::set_operation(a, b, detail::SetOperation::Intersection);
+    }
+
+    /**
+     * Returns a new container with the elements of a that have no counterpart in b (a key occurring m
+     * times in a and n times in b is kept max(m - n, 0) times). See set_union.
+     */
+    template <typename T, typename Compare, typename Projection, size_t N>
+    MyContainer<T, Compare, Projection, N> set_difference(const MyContainer<T, Compare, Projection, N> &a, const MyContainer<T, Compare, Projection, N> &b)
+    {
+        return detail::set_operation(a, b, detail::SetOperation::Difference);
+    }
+
+    /**
+     * Returns a new container with the elements of a without counterpart in b and the elements of b
+     * without counterpart in a. See set_union.
+     */
+    template <typename T, typename Compare, typename Projection, size_t N>
+    MyContainer<T, Compare, Projection, N> symmetric_difference(const MyContainer<T, Compare, Projection, N> &a, const MyContainer<T, Compare, Projection, N> &b)
+    {
+        return detail::set_operation(a, b, detail::SetOperation::SymmetricDifference);
+    }
+
+}
+#endif
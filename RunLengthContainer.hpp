@@ -0,0 +1,192 @@
+//ronamsalem4@gmail.com
+#ifndef __RUNLENGTHCONTAINER_HPP
+#define __RUNLENGTHCONTAINER_HPP
+#include "MyContainer.hpp"
+#include <map>
+#include <iostream>
+#include <stdexcept>
+/**
+ * A compressed container for data with few distinct values.
+ * RunLengthContainer stores every distinct value once, together with its number of copies, in a
+ * balanced search tree (std::map). Memory and sorting cost depend on the number of distinct values d
+ * instead of the number of elements n:
+ * - addElement is O(log d), removeElement (all copies of a value, as in MyContainer) is O(log d).
+ * - AscendingIterator, DescendingIterator and SideCrossIterator expand the counts on the fly,
+ *   no sorted copy of the elements is ever made.
+ * The insertion order is not kept, so the insertion-order views (Order, ReverseOrder,
+ * MiddleOutOrder) are not available in this representation.
+ * Any modification invalidates the iterators.
+ */
+
+namespace ariel
+{
+    /**
+     * @class ---> RunLengthContainer
+     * Keeps (value, count) pairs sorted by value.
+     * @tparam ---> T The type of elements stored in the container. Defaults to int.
+     */
+    template <typename T = int>
+    class RunLengthContainer
+    {
+    private:
+        std::map<T, size_t> counts; //< Distinct value ---> number of copies.
+        size_t total = 0;           //< Number of elements, copies included.
+
+    public:
+        /**
+         *  Adds an element to the container.
+         * @param val ---> The element to be added.
+         */
+        void addElement(const T &val)
+        {
+            counts[val]++;
+            total++;
+        }
+
+        /**
+         * Removes all occurrences of an element from the container in O(log d).
+         * @param val ---> The element to be removed.
+         * @throws ---> std::invalid_argument if the element is not found.
+         */
+        void removeElement(const T &val)
+        {
+            auto found = counts.find(val);
+            if (found == counts.end())
+            {
+                throw std::invalid_argument("Element not found in container");
+            }
+            total -= found->second;
+            counts.erase(found);
+        }
+
+        /**
+         * Returns the number of elements, copies included.
+         */
+        size_t size() const { return total; }
+
+        /**
+         * Returns the number of distinct values.
+         */
+        size_t distinct_count() const { return counts.size(); }
+
+        /**
+         * Returns the number of copies of a value (0 if it is not in the container).
+         * @param val ---> The value to count.
+         */
+        size_t count(const T &val) const
+        {
+            auto found = counts.find(val);
+            return found == counts.end() ? 0 : found->second;
+        }
+
+        /**
+         * Prints all elements in ascending order (the insertion order is not kept).
+         */
+        friend std::ostream &operator<<(std::ostream &os, const RunLengthContainer &container)
+        {
+            for (const auto &[value, copies] : container.counts)
+                for (size_t i = 0; i < copies; i++)
+                    os << value << " ";
+            return os;
+        }
+
+        /**
+         * @class ---> Iterator
+         * Iterator over one of the value-ordered views. It keeps a cursor on the smallest and on the
+         * largest values not visited yet, together with the number of copies of each that were already
+         * returned, so duplicates are expanded without being stored.
+         * Modifying the container invalidates all of its iterators (they point into the tree).
+         */
+        class Iterator
+        {
+        private:
+            const RunLengthContainer *container;
+            TraversalOrder order;
+            size_t index;
+            typename std::map<T, size_t>::const_iterator low;          //< Next value from the small end.
+            size_t low_used = 0;                                       //< Copies of *low already returned.
+            typename std::map<T, size_t>::const_reverse_iterator high; //< Next value from the large end.
+            size_t high_used = 0;                                      //< Copies of *high already returned.
+
+            bool from_low() const
+            {
+                return order == TraversalOrder::Ascending || (order == TraversalOrder::SideCross && index % 2 == 0);
+            }
+
+        public:
+            Iterator(const RunLengthContainer &contain, TraversalOrder o, bool end)
+                : container(&contain), order(o), index(end ? contain.total : 0),
+                  low(contain.counts.begin()), high(contain.counts.rbegin()) {}
+
+            /**
+             * Dereference operator to access current element.
+             * @throws ---> std::out_of_range if the index is beyond the end.
+             */
+            T operator*() const
+            {
+                if (index >= container->total)
+                {
+                    throw std::out_of_range("Dereferencing past-the-end iterator");
+                }
+                return from_low() ? low->first : high->first;
+            }
+
+            /**
+             * Pre-increment operator. At or past the end only the position advances (like the
+             * MyContainer iterators); the cursors are not touched.
+             */
+            Iterator &operator++()
+            {
+                if (index >= container->total)
+                {
+                    index++;
+                    return *this;
+                }
+                if (from_low())
+                {
+                    if (++low_used == low->second)
+                    {
+                        ++low;
+                        low_used = 0;
+                    }
+                }
+                else if (++high_used == high->second)
+                {
+                    ++high;
+                    high_used = 0;
+                }
+                index++;
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator temp = *this;
+                ++(*this);
+                return temp;
+            }
+
+            bool operator==(const Iterator &other) const { return index == other.index; }
+
+            /**
+             * @throws---->  std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator!=(const Iterator &other) const
+            {
+                if (container != other.container)
+                {
+                    throw std::invalid_argument("Cannot compare iterators from different containers");
+                }
+                return index != other.index;
+            }
+        };
+
+        Iterator begin_ascending_order() const { return Iterator(*this, TraversalOrder::Ascending, false); }
+        Iterator end_ascending_order() const { return Iterator(*this, TraversalOrder::Ascending, true); }
+        Iterator begin_descending_order() const { return Iterator(*this, TraversalOrder::Descending, false); }
+        Iterator end_descending_order() const { return Iterator(*this, TraversalOrder::Descending, true); }
+        Iterator begin_side_cross_order() const { return Iterator(*this, TraversalOrder::SideCross, false); }
+        Iterator end_side_cross_order() const { return Iterator(*this, TraversalOrder::SideCross, true); }
+    };
+}
+#endif
@@ -0,0 +1,477 @@
+//ronamsalem4@gmail.com
+#ifndef __SHAREDCONTAINER_HPP
+#define __SHAREDCONTAINER_HPP
+#include "MyContainer.hpp"
+#include <string>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+/**
+ * A container that lives in a named POSIX shared-memory segment, so that several processes on one
+ * host can use a single copy of the data.
+ * The segment holds a header (capacity, size, version counter and a process-shared reader-writer
+ * lock), the elements and the sorted permutation used by the value orders. Everything inside the
+ * segment is addressed by offsets from its start, because every process maps it at another address.
+ * A loader process create()s the segment and fills it; other processes open() it and iterate all six
+ * orders zero-copy: the iterators return references into the shared elements.
+ * Writers take the lock exclusively. Readers that may run concurrently with a writer hold read_lock()
+ * while iterating; in addition every iterator checks the version counter on dereference and throws
+ * std::logic_error if the container was modified after the iterator was created.
+ * T must be trivially copyable. The capacity is fixed when the segment is created.
+ */
+
+namespace ariel
+{
+    /**
+     * @class ---> SharedContainer
+     * A handle to a container in a named shared-memory segment. Handles are move-only; destroying
+     * a handle unmaps the segment but does not remove it (see remove()).
+     * @tparam ---> T The type of elements (trivially copyable).
+     * @tparam ---> Compare Strict weak ordering of the elements. Defaults to std::less<>.
+     */
+    template <typename T = int, typename Compare = std::less<>>
+    class SharedContainer
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "SharedContainer requires a trivially copyable element type");
+        static_assert(std::atomic<std::uint64_t>::is_always_lock_free, "Shared counters must be lock-free to be process-shared");
+        static_assert(sizeof(size_t) == sizeof(std::uint64_t), "The sorted permutation is stored as 64-bit indices");
+
+    private:
+        static constexpr std::uint64_t MAGIC = 0x4152494553484d31; //< Marks an initialized segment.
+        static constexpr std::uint64_t FORMAT = 1;                 //< Layout version of the segment.
+
+        struct Header
+        {
+            std::atomic<std::uint64_t> magic;
+            std::uint64_t format;
+            std::uint64_t element_size;
+            std::uint64_t capacity;
+            std::uint64_t elements_offset;         //< Offset of the elements from the segment start.
+            std::uint64_t index_offset;            //< Offset of the sorted permutation.
+            std::atomic<std::uint64_t> size;
+            std::atomic<std::uint64_t> version;    //< Incremented by every modification.
+            std::atomic<std::uint64_t> index_version; //< Version the sorted permutation was built for.
+            pthread_rwlock_t lock;
+        };
+
+        std::string name;
+        int fd = -1;
+        unsigned char *base = nullptr; //< Start of the mapping in this process.
+        size_t mapped = 0;
+        [[no_unique_address]] Compare comp;
+        mutable std::atomic<size_t> reads_held{0}; //< read_lock() guards held through this handle (by any thread).
+
+        Header &header() const { return *reinterpret_cast<Header *>(base); }
+        T *data() const { return reinterpret_cast<T *>(base + header().elements_offset); }
+        size_t *index() const { return reinterpret_cast<size_t *>(base + header().index_offset); }
+
+        static size_t align(size_t offset) { return (offset + 63) / 64 * 64; }
+
+        SharedContainer(std::string segment, int descriptor, void *address, size_t bytes, Compare compare)
+            : name(std::move(segment)), fd(descriptor), base(static_cast<unsigned char *>(address)), mapped(bytes), comp(std::move(compare)) {}
+
+        [[noreturn]] static void fail(const char *what)
+        {
+            throw std::system_error(errno, std::generic_category(), what);
+        }
+
+        /**
+         * Checks that a mapping of the given size holds a segment written by create() for this element
+         * type, and that every region the header points to lies inside the mapping (touching memory past
+         * the end of a shared-memory object raises SIGBUS).
+         */
+        static bool valid_layout(const Header &h, size_t bytes)
+        {
+            if (h.magic.load(std::memory_order_acquire) != MAGIC || h.format != FORMAT || h.element_size != sizeof(T))
+                return false;
+            if (h.elements_offset < sizeof(Header) || h.elements_offset > h.index_offset || h.index_offset > bytes)
+                return false;
+            if (h.capacity > (h.index_offset - h.elements_offset) / sizeof(T) || h.capacity > (bytes - h.index_offset) / sizeof(size_t))
+                return false;
+            return h.size.load(std::memory_order_acquire) <= h.capacity;
+        }
+
+        /**
+         * Unmaps the segment and closes the descriptor.
+         */
+        void release()
+        {
+            if (base)
+                munmap(base, mapped);
+            if (fd >= 0)
+                close(fd);
+        }
+
+        void lock_exclusive() const { pthread_rwlock_wrlock(&header().lock); }
+        void lock_shared() const { pthread_rwlock_rdlock(&header().lock); }
+        void unlock() const { pthread_rwlock_unlock(&header().lock); }
+
+        /**
+         * Rebuilds the sorted permutation if a modification made it stale.
+         * @throws ---> std::logic_error if it is stale while this handle holds a read lock (rebuilding
+         * would need the write lock and deadlock).
+         */
+        const size_t *sorted_index() const
+        {
+            Header &h = header();
+            if (h.index_version.load(std::memory_order_acquire) != h.version.load(std::memory_order_acquire))
+            {
+                if (reads_held > 0)
+                {
+                    throw std::logic_error("Sorted index is out of date; build it before taking a read lock");
+                }
+                lock_exclusive();
+                if (h.index_version.load() != h.version.load())
+                {
+                    size_t n = h.size.load();
+                    std::vector<size_t> sorted = detail::sorted_permutation(std::span<const T>(data(), n), comp, std::identity());
+                    std::copy(sorted.begin(), sorted.end(), index());
+                    h.index_version.store(h.version.load(), std::memory_order_release);
+                }
+                unlock();
+            }
+            return index();
+        }
+
+    public:
+        /**
+         * Creates and maps a new segment.
+         * @param segment ---> The segment name (for example "/prices"), as for shm_open.
+         * @param capacity ---> The largest number of elements.
+         * @param compare ---> The ordering of the value orders.
+         * @throws ---> std::system_error if the segment exists already or cannot be created.
+         */
+        static SharedContainer create(const std::string &segment, size_t capacity, Compare compare = Compare())
+        {
+            size_t elements_offset = align(sizeof(Header));
+            size_t index_offset = align(elements_offset + capacity * sizeof(T));
+            size_t bytes = index_offset + capacity * sizeof(size_t);
+            int descriptor = shm_open(segment.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+            if (descriptor < 0)
+                fail("shm_open");
+            if (ftruncate(descriptor, static_cast<off_t>(bytes)) != 0)
+            {
+                int error = errno;
+                close(descriptor);
+                shm_unlink(segment.c_str());
+                errno = error;
+                fail("ftruncate");
+            }
+            void *address = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+            if (address == MAP_FAILED)
+            {
+                int error = errno;
+                close(descriptor);
+                shm_unlink(segment.c_str());
+                errno = error;
+                fail("mmap");
+            }
+            Header *h = new (address) Header;
+            h->format = FORMAT;
+            h->element_size = sizeof(T);
+            h->capacity = capacity;
+            h->elements_offset = elements_offset;
+            h->index_offset = index_offset;
+            h->size.store(0);
+            h->version.store(1);
+            h->index_version.store(0);
+            pthread_rwlockattr_t attributes;
+            pthread_rwlockattr_init(&attributes);
+            pthread_rwlockattr_setpshared(&attributes, PTHREAD_PROCESS_SHARED);
+            pthread_rwlock_init(&h->lock, &attributes);
+            pthread_rwlockattr_destroy(&attributes);
+            h->magic.store(MAGIC, std::memory_order_release);
+            return SharedContainer(segment, descriptor, address, bytes, std::move(compare));
+        }
+
+        /**
+         * Maps an existing segment created by create().
+         * @throws ---> std::system_error if it cannot be opened, std::runtime_error if it does not hold
+         * a SharedContainer of this element type and layout version, or is smaller than its header says.
+         */
+        static SharedContainer open(const std::string &segment, Compare compare = Compare())
+        {
+            int descriptor = shm_open(segment.c_str(), O_RDWR, 0600);
+            if (descriptor < 0)
+                fail("shm_open");
+            struct stat info;
+            if (fstat(descriptor, &info) != 0)
+            {
+                int error = errno;
+                close(descriptor);
+                errno = error;
+                fail("fstat");
+            }
+            size_t bytes = static_cast<size_t>(info.st_size);
+            void *address = bytes < sizeof(Header) ? MAP_FAILED : mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, descriptor, 0);
+            if (address == MAP_FAILED)
+            {
+                close(descriptor);
+                throw std::runtime_error("Shared segment is not a SharedContainer");
+            }
+            SharedContainer handle(segment, descriptor, address, bytes, std::move(compare));
+            if (!valid_layout(handle.header(), bytes))
+            {
+                throw std::runtime_error("Shared segment is not a SharedContainer of this element type");
+            }
+            return handle;
+        }
+
+        /**
+         * Removes a segment name; processes that mapped it keep their mapping.
+         * @return ---> False if there was no such segment.
+         */
+        static bool remove(const std::string &segment)
+        {
+            return shm_unlink(segment.c_str()) == 0;
+        }
+
+        SharedContainer(SharedContainer &&other) noexcept
+            : name(std::move(other.name)), fd(std::exchange(other.fd, -1)), base(std::exchange(other.base, nullptr)),
+              mapped(std::exchange(other.mapped, 0)), comp(std::move(other.comp)), reads_held(other.reads_held.exchange(0)) {}
+
+        SharedContainer &operator=(SharedContainer &&other) noexcept
+        {
+            if (this != &other)
+            {
+                release();
+                name = std::move(other.name);
+                fd = std::exchange(other.fd, -1);
+                base = std::exchange(other.base, nullptr);
+                mapped = std::exchange(other.mapped, 0);
+                comp = std::move(other.comp);
+                reads_held.store(other.reads_held.exchange(0));
+            }
+            return *this;
+        }
+
+        SharedContainer(const SharedContainer &) = delete;
+        SharedContainer &operator=(const SharedContainer &) = delete;
+
+        ~SharedContainer() { release(); }
+
+        /**
+         * @class ---> ReadGuard
+         * Holds the shared lock of the segment (see read_lock).
+         */
+        class ReadGuard
+        {
+        private:
+            const SharedContainer *container;
+
+        public:
+            explicit ReadGuard(const SharedContainer &c) : container(&c)
+            {
+                container->lock_shared();
+                container->reads_held++;
+            }
+            ReadGuard(ReadGuard &&other) noexcept : container(std::exchange(other.container, nullptr)) {}
+            ReadGuard(const ReadGuard &) = delete;
+            ReadGuard &operator=(const ReadGuard &) = delete;
+            ReadGuard &operator=(ReadGuard &&) = delete;
+            ~ReadGuard()
+            {
+                if (container)
+                {
+                    container->reads_held--;
+                    container->unlock();
+                }
+            }
+        };
+
+        /**
+         * Takes the shared lock until the returned guard is destroyed; writers wait meanwhile.
+         * Create the value-order iterators before, or make sure the sorted index is current.
+         */
+        ReadGuard read_lock() const { return ReadGuard(*this); }
+
+        /**
+         *  Adds an element to the container.
+         * @param val ---> The element to be added.
+         * @throws ---> std::length_error if the segment is full.
+         */
+        void addElement(const T &val)
+        {
+            lock_exclusive();
+            Header &h = header();
+            size_t n = h.size.load();
+            if (n == h.capacity)
+            {
+                unlock();
+                throw std::length_error("SharedContainer is full");
+            }
+            data()[n] = val;
+            h.size.store(n + 1, std::memory_order_release);
+            h.version.fetch_add(1, std::memory_order_acq_rel);
+            unlock();
+        }
+
+        /**
+         * Removes all occurrences of an element from the container.
+         * @param val ---> The element to be removed.
+         * @throws ---> std::invalid_argument if the element is not found.
+         */
+        void removeElement(const T &val)
+        {
+            lock_exclusive();
+            Header &h = header();
+            size_t n = h.size.load();
+            size_t kept = static_cast<size_t>(std::remove(data(), data() + n, val) - data());
+            if (kept == n)
+            {
+                unlock();
+                throw std::invalid_argument("Element not found in container");
+            }
+            h.size.store(kept, std::memory_order_release);
+            h.version.fetch_add(1, std::memory_order_acq_rel);
+            unlock();
+        }
+
+        /**
+         * Builds the sorted permutation now (for example at the end of loading), so that readers never
+         * have to take the write lock to build it.
+         */
+        void build_index() const { sorted_index(); }
+
+        /**
+         * Returns the number of elements currently in the container.
+         */
+        size_t size() const { return header().size.load(std::memory_order_acquire); }
+
+        /**
+         * Returns the capacity fixed at creation.
+         */
+        size_t capacity() const { return header().capacity; }
+
+        /**
+         * Returns the version counter, incremented by every modification in any process.
+         */
+        std::uint64_t version() const { return header().version.load(std::memory_order_acquire); }
+
+        /**
+         *  Prints all elements in insertion order.
+         */
+        friend std::ostream &operator<<(std::ostream &os, const SharedContainer &container)
+        {
+            size_t n = container.size();
+            for (size_t i = 0; i < n; i++)
+                os << container.data()[i] << " ";
+            return os;
+        }
+
+        /**
+         * @class ---> Iterator
+         * Zero-copy iterator over one of the six traversal orders: a position is mapped to an element
+         * of the segment (through the shared sorted permutation for the value orders).
+         */
+        class Iterator
+        {
+        private:
+            const SharedContainer *container;
+            TraversalOrder order;
+            const size_t *sorted; //< Sorted permutation (value orders only).
+            size_t count;         //< Number of elements when the iterator was created.
+            std::uint64_t version;
+            size_t index;
+
+        public:
+            /**
+             * Captures the version, the size and (for the value orders) the sorted permutation as one
+             * consistent snapshot: they are read under the shared lock, and if a writer got in after the
+             * permutation was built, it is rebuilt and the snapshot taken again.
+             */
+            Iterator(const SharedContainer &contain, TraversalOrder o, bool end)
+                : container(&contain), order(o), sorted(nullptr), count(0), version(0), index(0)
+            {
+                bool value_order = detail::is_value_order(o);
+                for (;;)
+                {
+                    if (value_order)
+                        sorted = contain.sorted_index();
+                    bool lock = contain.reads_held == 0; //< Otherwise this handle already excludes writers.
+                    if (lock)
+                        contain.lock_shared();
+                    version = contain.version();
+                    count = contain.size();
+                    bool current = !value_order || contain.header().index_version.load(std::memory_order_acquire) == version;
+                    if (lock)
+                        contain.unlock();
+                    if (current)
+                        break;
+                }
+                index = end ? count : 0;
+            }
+
+            /**
+             * Dereference operator to access current element.
+             * @throws ---> std::out_of_range if the index is beyond the end, std::logic_error if the
+             * container was modified after the iterator was created.
+             */
+            const T &operator*() const
+            {
+                if (container->version() != version)
+                {
+                    throw std::logic_error("Iterator used after its container was modified");
+                }
+                if (index >= count)
+                {
+                    throw std::out_of_range("Dereferencing past-the-end iterator");
+                }
+                return container->data()[detail::traversal_index(order, count, index, sorted)];
+            }
+
+            const T *operator->() const { return &**this; }
+
+            Iterator &operator++()
+            {
+                index++;
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator temp = *this;
+                ++(*this);
+                return temp;
+            }
+
+            bool operator==(const Iterator &other) const { return index == other.index; }
+
+            /**
+             * @throws---->  std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator!=(const Iterator &other) const
+            {
+                if (container != other.container)
+                {
+                    throw std::invalid_argument("Cannot compare iterators from different containers");
+                }
+                return index != other.index;
+            }
+        };
+
+        Iterator begin_ascending_order() const { return Iterator(*this, TraversalOrder::Ascending, false); }
+        Iterator end_ascending_order() const { return Iterator(*this, TraversalOrder::Ascending, true); }
+        Iterator begin_descending_order() const { return Iterator(*this, TraversalOrder::Descending, false); }
+        Iterator end_descending_order() const { return Iterator(*this, TraversalOrder::Descending, true); }
+        Iterator begin_side_cross_order() const { return Iterator(*this, TraversalOrder::SideCross, false); }
+        Iterator end_side_cross_order() const { return Iterator(*this, TraversalOrder::SideCross, true); }
+        Iterator begin_reverse_order() const { return Iterator(*this, TraversalOrder::Reverse, false); }
+        Iterator end_reverse_order() const { return Iterator(*this, TraversalOrder::Reverse, true); }
+        Iterator begin_order() const { return Iterator(*this, TraversalOrder::Insertion, false); }
+        Iterator end_order() const { return Iterator(*this, TraversalOrder::Insertion, true); }
+        Iterator begin_middle_out_order() const { return Iterator(*this, TraversalOrder::MiddleOut, false); }
+        Iterator end_middle_out_order() const { return Iterator(*this, TraversalOrder::MiddleOut, true); }
+    };
+}
+#endif
@@ -0,0 +1,299 @@
+//ronamsalem4@gmail.com
+#ifndef __SIMDKERNELS_HPP
+#define __SIMDKERNELS_HPP
+#include <array>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <type_traits>
+/**
+ * Vectorized equality kernels used by MyContainer::contains, count and removeElement.
+ * For arithmetic element types of 1, 2, 4 or 8 bytes the data is compared one vector at a time:
+ * 32 bytes per step with AVX2 or 16 bytes per step with SSE2, and the comparison masks are turned into
+ * counts with popcount. Removal of 4 and 8 byte elements is a stream compaction: the lanes to keep are
+ * packed to the front of the vector with a permutation looked up in a shuffle table.
+ * The instruction set is chosen at run time (CPU feature detection), and every kernel has a scalar
+ * fallback, which is also what non-x86 builds and all other element types use.
+ * Floating point lanes are compared with ordered equality, exactly like operator== (NaN never matches,
+ * 0.0 matches -0.0).
+ */
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ARIEL_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define ARIEL_SIMD_X86 0
+#endif
+
+namespace ariel
+{
+    namespace simd
+    {
+        /**
+         * True for the element types that have vector kernels.
+         */
+        template <typename T>
+        inline constexpr bool is_vectorizable_v = std::is_arithmetic_v<T> && !std::is_same_v<T, bool> &&
+                                                  (sizeof(T) == 1 || sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8);
+
+#if ARIEL_SIMD_X86
+        /**
+         * Run-time CPU feature detection, evaluated once.
+         */
+        inline bool has_avx2()
+        {
+            static const bool supported = __builtin_cpu_supports("avx2");
+            return supported;
+        }
+
+        inline bool has_sse2()
+        {
+            static const bool supported = __builtin_cpu_supports("sse2");
+            return supported;
+        }
+
+        /**
+         * Shuffle table for the compaction of 8 x 32-bit lanes: entry m lists the lanes whose bit is set in m
+         * first, in order. For 4 x 64-bit lanes only the first 16 entries are used, with every 64-bit lane
+         * expanded to its two 32-bit halves.
+         */
+        struct CompressTables
+        {
+            alignas(32) std::int32_t lanes32[256][8];
+            alignas(32) std::int32_t lanes64[16][8];
+
+            constexpr CompressTables() : lanes32(), lanes64()
+            {
+                for (int mask = 0; mask < 256; mask++)
+                {
+                    int out = 0;
+                    for (int lane = 0; lane < 8; lane++)
+                        if (mask & (1 << lane))
+                            lanes32[mask][out++] = lane;
+                    for (; out < 8; out++)
+                        lanes32[mask][out] = 0;
+                }
+                for (int mask = 0; mask < 16; mask++)
+                {
+                    int out = 0;
+                    for (int lane = 0; lane < 4; lane++)
+                        if (mask & (1 << lane))
+                        {
+                            lanes64[mask][out++] = 2 * lane;
+                            lanes64[mask][out++] = 2 * lane + 1;
+                        }
+                    for (; out < 8; out++)
+                        lanes64[mask][out] = 0;
+                }
+            }
+        };
+
+        inline constexpr CompressTables compress_tables{};
+
+        /**
+         * Mask of the lanes of 32 bytes at p equal to value (AVX2). Lanes wider than one byte may set
+         * several bits each, see mask_bits.
+         */
+        template <typename T>
+        __attribute__((target("avx2"))) inline unsigned equal_mask_avx2(const T *p, T value)
+        {
+            if constexpr (std::is_same_v<T, float>)
+                return static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(p), _mm256_set1_ps(value), _CMP_EQ_OQ)));
+            else if constexpr (std::is_same_v<T, double>)
+                return static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(p), _mm256_set1_pd(value), _CMP_EQ_OQ)));
+            else
+            {
+                __m256i data = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+                if constexpr (sizeof(T) == 1)
+                    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(data, _mm256_set1_epi8(static_cast<char>(value)))));
+                else if constexpr (sizeof(T) == 2)
+                    return static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi16(data, _mm256_set1_epi16(static_cast<short>(value)))));
+                else if constexpr (sizeof(T) == 4)
+                    return static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(data, _mm256_set1_epi32(static_cast<int>(value))))));
+                else
+                    return static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(data, _mm256_set1_epi64x(static_cast<long long>(value))))));
+            }
+        }
+
+        /**
+         * Mask of the lanes of 16 bytes at p equal to value (SSE2).
+         */
+        template <typename T>
+        __attribute__((target("sse2"))) inline unsigned equal_mask_sse2(const T *p, T value)
+        {
+            if constexpr (std::is_same_v<T, float>)
+                return static_cast<unsigned>(_mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(p), _mm_set1_ps(value))));
+            else if constexpr (std::is_same_v<T, double>)
+                return static_cast<unsigned>(_mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(p), _mm_set1_pd(value))));
+            else
+            {
+                __m128i data = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+                if constexpr (sizeof(T) == 1)
+                    return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(data, _mm_set1_epi8(static_cast<char>(value)))));
+                else if constexpr (sizeof(T) == 2)
+                    return static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi16(data, _mm_set1_epi16(static_cast<short>(value)))));
+                else if constexpr (sizeof(T) == 4)
+                    return static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(data, _mm_set1_epi32(static_cast<int>(value))))));
+                else
+                {
+                    // SSE2 has no 64-bit compare: both 32-bit halves must match.
+                    __m128i eq = _mm_cmpeq_epi32(data, _mm_set1_epi64x(static_cast<long long>(value)));
+                    eq = _mm_and_si128(eq, _mm_shuffle_epi32(eq, _MM_SHUFFLE(2, 3, 0, 1)));
+                    return static_cast<unsigned>(_mm_movemask_pd(_mm_castsi128_pd(eq)));
+                }
+            }
+        }
+
+        /**
+         * Number of mask bits set by one matching lane (1 and 2 byte lanes use the byte mask).
+         */
+        template <typename T>
+        inline constexpr unsigned mask_bits = (sizeof(T) <= 2) ? static_cast<unsigned>(sizeof(T)) : 1u;
+
+        template <typename T>
+        __attribute__((target("avx2,popcnt"))) size_t count_avx2(const T *data, size_t n, T value)
+        {
+            constexpr size_t lanes = 32 / sizeof(T);
+            size_t bits = 0, i = 0;
+            for (; i + lanes <= n; i += lanes)
+                bits += static_cast<size_t>(__builtin_popcount(equal_mask_avx2(data + i, value)));
+            size_t total = bits / mask_bits<T>;
+            for (; i < n; i++)
+                total += (data[i] == value);
+            return total;
+        }
+
+        template <typename T>
+        __attribute__((target("sse2"))) size_t count_sse2(const T *data, size_t n, T value)
+        {
+            constexpr size_t lanes = 16 / sizeof(T);
+            size_t bits = 0, i = 0;
+            for (; i + lanes <= n; i += lanes)
+                bits += static_cast<size_t>(__builtin_popcount(equal_mask_sse2(data + i, value)));
+            size_t total = bits / mask_bits<T>;
+            for (; i < n; i++)
+                total += (data[i] == value);
+            return total;
+        }
+
+        template <typename T>
+        __attribute__((target("avx2"))) bool contains_avx2(const T *data, size_t n, T value)
+        {
+            constexpr size_t lanes = 32 / sizeof(T);
+            size_t i = 0;
+            for (; i + lanes <= n; i += lanes)
+                if (equal_mask_avx2(data + i, value) != 0)
+                    return true;
+            for (; i < n; i++)
+                if (data[i] == value)
+                    return true;
+            return false;
+        }
+
+        template <typename T>
+        __attribute__((target("sse2"))) bool contains_sse2(const T *data, size_t n, T value)
+        {
+            constexpr size_t lanes = 16 / sizeof(T);
+            size_t i = 0;
+            for (; i + lanes <= n; i += lanes)
+                if (equal_mask_sse2(data + i, value) != 0)
+                    return true;
+            for (; i < n; i++)
+                if (data[i] == value)
+                    return true;
+            return false;
+        }
+
+        /**
+         * Stable stream compaction of 4 or 8 byte lanes (AVX2): the kept lanes of every vector are packed
+         * with one permutation from the shuffle table and stored at the write position. The write position
+         * never passes the read position, so a store only overwrites data that was already loaded.
+         */
+        template <typename T>
+        __attribute__((target("avx2,popcnt"))) size_t remove_avx2(T *data, size_t n, T value)
+        {
+            constexpr size_t lanes = 32 / sizeof(T);
+            constexpr unsigned all = (1u << lanes) - 1;
+            size_t write = 0, i = 0;
+            for (; i + lanes <= n; i += lanes)
+            {
+                unsigned keep = ~equal_mask_avx2(data + i, value) & all;
+                if (keep == all)
+                {
+                    if (write != i)
+                        _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + write), _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)));
+                    write += lanes;
+                    continue;
+                }
+                const std::int32_t *row = (sizeof(T) == 4) ? compress_tables.lanes32[keep] : compress_tables.lanes64[keep];
+                __m256i packed = _mm256_permutevar8x32_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i)),
+                                                             _mm256_load_si256(reinterpret_cast<const __m256i *>(row)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + write), packed);
+                write += static_cast<size_t>(__builtin_popcount(keep));
+            }
+            for (; i < n; i++)
+                if (!(data[i] == value))
+                    data[write++] = data[i];
+            return write;
+        }
+#endif
+
+        /**
+         * Counts the elements equal to value.
+         * @param data ---> First element.
+         * @param n ---> Number of elements.
+         * @param value ---> The value to look for.
+         * @return ---> The number of matching elements.
+         */
+        template <typename T>
+        size_t count(const T *data, size_t n, const T &value)
+        {
+#if ARIEL_SIMD_X86
+            if constexpr (is_vectorizable_v<T>)
+            {
+                if (has_avx2())
+                    return count_avx2(data, n, value);
+                if (has_sse2())
+                    return count_sse2(data, n, value);
+            }
+#endif
+            return static_cast<size_t>(std::count(data, data + n, value));
+        }
+
+        /**
+         * Returns true if any element equals value.
+         */
+        template <typename T>
+        bool contains(const T *data, size_t n, const T &value)
+        {
+#if ARIEL_SIMD_X86
+            if constexpr (is_vectorizable_v<T>)
+            {
+                if (has_avx2())
+                    return contains_avx2(data, n, value);
+                if (has_sse2())
+                    return contains_sse2(data, n, value);
+            }
+#endif
+            return std::find(data, data + n, value) != data + n;
+        }
+
+        /**
+         * Removes every element equal to value, keeping the order of the others (like std::remove).
+         * @return ---> The new number of elements; the elements after it are unspecified.
+         */
+        template <typename T>
+        size_t remove(T *data, size_t n, const T &value)
+        {
+#if ARIEL_SIMD_X86
+            if constexpr (is_vectorizable_v<T> && sizeof(T) >= 4)
+            {
+                if (has_avx2())
+                    return remove_avx2(data, n, value);
+            }
+#endif
+            return static_cast<size_t>(std::remove(data, data + n, value) - data);
+        }
+    }
+}
+#endif
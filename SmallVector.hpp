@@ -0,0 +1,246 @@
+//ronamsalem4@gmail.com
+#ifndef __SMALLVECTOR_HPP
+#define __SMALLVECTOR_HPP
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <iterator>
+#include <algorithm>
+#include <stdexcept>
+#include <type_traits>
+/**
+ * A vector with inline storage for its first N elements, used by MyContainer when an inline capacity
+ * is requested. Up to N elements live inside the object itself, so a small container (and every iterator
+ * snapshot of it) is built without any heap allocation. When the N + 1st element is added the elements
+ * move to a heap buffer that grows geometrically, exactly like std::vector.
+ * Only the part of the std::vector interface that the containers use is provided.
+ */
+
+namespace ariel
+{
+    /**
+     * @class ---> SmallVector
+     * @tparam ---> T The element type.
+     * @tparam ---> N Number of elements stored inline (at least 1).
+     */
+    template <typename T, size_t N>
+    class SmallVector
+    {
+        static_assert(N > 0, "SmallVector needs an inline capacity of at least one element");
+
+    private:
+        alignas(T) unsigned char storage[N * sizeof(T)]; //< Inline buffer.
+        T *ptr;                                           //< Current buffer: storage or a heap block.
+        size_t count = 0;
+        size_t cap = N;
+
+        T *inline_data() { return std::launder(reinterpret_cast<T *>(storage)); }
+        bool is_inline() const { return ptr == reinterpret_cast<const T *>(storage); }
+
+        /**
+         * Moves the elements to a heap buffer of the given capacity.
+         */
+        void grow(size_t capacity)
+        {
+            T *block = std::allocator<T>().allocate(capacity);
+            std::uninitialized_move(ptr, ptr + count, block);
+            std::destroy(ptr, ptr + count);
+            release();
+            ptr = block;
+            cap = capacity;
+        }
+
+        /**
+         * Returns the heap buffer, if any (the elements must already be destroyed).
+         */
+        void release()
+        {
+            if (!is_inline())
+                std::allocator<T>().deallocate(ptr, cap);
+            ptr = inline_data();
+            cap = N;
+        }
+
+        /**
+         * Takes the elements of other, which is left empty (this must be empty and inline).
+         */
+        void take(SmallVector &other)
+        {
+            if (other.is_inline())
+            {
+                std::uninitialized_move(other.begin(), other.end(), ptr);
+                count = other.count;
+                other.clear();
+                return;
+            }
+            ptr = other.ptr;
+            count = other.count;
+            cap = other.cap;
+            other.ptr = other.inline_data();
+            other.count = 0;
+            other.cap = N;
+        }
+
+    public:
+        using value_type = T;
+        using size_type = size_t;
+        using iterator = T *;
+        using const_iterator = const T *;
+        using reverse_iterator = std::reverse_iterator<T *>;
+        using const_reverse_iterator = std::reverse_iterator<const T *>;
+
+        SmallVector() : ptr(inline_data()) {}
+
+        template <typename It>
+        SmallVector(It first, It last) : ptr(inline_data())
+        {
+            reserve(static_cast<size_t>(std::distance(first, last)));
+            for (; first != last; ++first)
+                push_back(*first);
+        }
+
+        SmallVector(const SmallVector &other) : SmallVector(other.begin(), other.end()) {}
+
+        SmallVector(SmallVector &&other) noexcept(std::is_nothrow_move_constructible_v<T>) : ptr(inline_data())
+        {
+            take(other);
+        }
+
+        /**
+         * Copy-and-swap: if copying an element throws, this vector is left unchanged.
+         */
+        SmallVector &operator=(const SmallVector &other)
+        {
+            if (this != &other)
+            {
+                SmallVector copy(other);
+                swap(copy);
+            }
+            return *this;
+        }
+
+        SmallVector &operator=(SmallVector &&other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            if (this != &other)
+            {
+                clear();
+                release();
+                take(other);
+            }
+            return *this;
+        }
+
+        ~SmallVector()
+        {
+            clear();
+            release();
+        }
+
+        /**
+         * Exchanges the contents. Heap buffers are exchanged by pointer; inline elements are moved.
+         */
+        void swap(SmallVector &other) noexcept(std::is_nothrow_move_constructible_v<T>)
+        {
+            SmallVector tmp(std::move(other));
+            other = std::move(*this);
+            *this = std::move(tmp);
+        }
+
+        friend void swap(SmallVector &a, SmallVector &b) noexcept(std::is_nothrow_move_constructible_v<T>) { a.swap(b); }
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        size_t capacity() const { return cap; }
+
+        T *data() { return ptr; }
+        const T *data() const { return ptr; }
+        T *begin() { return ptr; }
+        T *end() { return ptr + count; }
+        const T *begin() const { return ptr; }
+        const T *end() const { return ptr + count; }
+        reverse_iterator rbegin() { return reverse_iterator(end()); }
+        reverse_iterator rend() { return reverse_iterator(begin()); }
+        const_reverse_iterator rbegin() const { return const_reverse_iterator(end()); }
+        const_reverse_iterator rend() const { return const_reverse_iterator(begin()); }
+
+        T &operator[](size_t i) { return ptr[i]; }
+        const T &operator[](size_t i) const { return ptr[i]; }
+        T &front() { return ptr[0]; }
+        const T &front() const { return ptr[0]; }
+        T &back() { return ptr[count - 1]; }
+        const T &back() const { return ptr[count - 1]; }
+
+        /**
+         * @throws ---> std::out_of_range if i >= size().
+         */
+        const T &at(size_t i) const
+        {
+            if (i >= count)
+            {
+                throw std::out_of_range("SmallVector index out of range");
+            }
+            return ptr[i];
+        }
+
+        void reserve(size_t capacity)
+        {
+            if (capacity > cap)
+                grow(capacity);
+        }
+
+        void push_back(const T &val) { emplace_back(val); }
+        void push_back(T &&val) { emplace_back(std::move(val)); }
+
+        template <typename... Args>
+        T &emplace_back(Args &&...args)
+        {
+            if (count == cap)
+            {
+                // Build the new element first: args may refer to an element of this vector.
+                T val(std::forward<Args>(args)...);
+                grow(2 * cap);
+                return *new (ptr + count++) T(std::move(val));
+            }
+            return *new (ptr + count++) T(std::forward<Args>(args)...);
+        }
+
+        void pop_back() { std::destroy_at(ptr + --count); }
+
+        /**
+         * Resizes to n elements; new elements are value-initialized.
+         */
+        void resize(size_t n)
+        {
+            if (n < count)
+            {
+                std::destroy(ptr + n, ptr + count);
+                count = n;
+                return;
+            }
+            reserve(n);
+            std::uninitialized_value_construct(ptr + count, ptr + n);
+            count = n;
+        }
+
+        void clear()
+        {
+            std::destroy(ptr, ptr + count);
+            count = 0;
+        }
+
+        /**
+         * Removes [first, last), shifting the following elements down.
+         * @return ---> An iterator to the element that followed the removed ones.
+         */
+        T *erase(const T *first, const T *last)
+        {
+            T *out = ptr + (first - ptr);
+            T *tail = std::move(out + (last - first), end(), out);
+            std::destroy(tail, end());
+            count = static_cast<size_t>(tail - ptr);
+            return out;
+        }
+    };
+}
+#endif
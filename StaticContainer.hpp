@@ -0,0 +1,213 @@
+//ronamsalem4@gmail.com
+#ifndef __STATICCONTAINER_HPP
+#define __STATICCONTAINER_HPP
+#include "MyContainer.hpp"
+#include <array>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+/**
+ * A fixed-capacity container that can be filled and traversed at compile time.
+ * StaticContainer keeps at most N elements in a std::array and never allocates. addElement,
+ * removeElement, the six traversal orders and to_array are all constexpr, so a lookup table
+ * built from a set known at compile time can be sorted by the compiler and stored in read-only
+ * data (see to_array), with no work at startup.
+ * The value orders use a stable insertion sort of an index array (constexpr, and the right
+ * algorithm for the small N this container is meant for). Descending is the exact reverse of
+ * ascending, as in MyContainer.
+ * T must be a literal, default constructible type for compile-time use.
+ */
+
+namespace ariel
+{
+    /**
+     * @class ---> StaticContainer
+     * @tparam ---> T The type of elements stored in the container.
+     * @tparam ---> N The capacity.
+     * @tparam ---> Compare Strict weak ordering of the keys. Defaults to std::less<>.
+     * @tparam ---> Projection Maps an element to the key that is compared. Defaults to std::identity.
+     */
+    template <typename T, size_t N, typename Compare = std::less<>, typename Projection = std::identity>
+    class StaticContainer
+    {
+    private:
+        std::array<T, N> elements{};
+        size_t count = 0;
+        [[no_unique_address]] Compare comp;
+        [[no_unique_address]] Projection proj;
+
+        /**
+         * Returns the stable ascending permutation of the elements (the first size() entries are used).
+         */
+        constexpr std::array<size_t, N> sorted_index() const
+        {
+            std::array<size_t, N> idx{};
+            for (size_t i = 0; i < count; i++)
+            {
+                size_t j = i;
+                while (j > 0 && std::invoke(comp, std::invoke(proj, elements[i]), std::invoke(proj, elements[idx[j - 1]])))
+                {
+                    idx[j] = idx[j - 1];
+                    j--;
+                }
+                idx[j] = i;
+            }
+            return idx;
+        }
+
+    public:
+        /**
+         * Creates an empty container.
+         * @param compare ---> The comparator of the keys.
+         * @param projection ---> The key extractor.
+         */
+        constexpr explicit StaticContainer(Compare compare = Compare(), Projection projection = Projection())
+            : comp(std::move(compare)), proj(std::move(projection)) {}
+
+        /**
+         *  Adds an element to the container.
+         * @param val ---> The element to be added.
+         * @throws ---> std::length_error if the container is full (a compile error in a constant expression).
+         */
+        constexpr void addElement(const T &val)
+        {
+            if (count == N)
+            {
+                throw std::length_error("StaticContainer is full");
+            }
+            elements[count++] = val;
+        }
+
+        /**
+         * Removes all occurrences of an element from the container.
+         * @param val ---> The element to be removed.
+         * @throws ---> std::invalid_argument if the element is not found.
+         */
+        constexpr void removeElement(const T &val)
+        {
+            size_t kept = 0;
+            for (size_t i = 0; i < count; i++)
+                if (!(elements[i] == val))
+                    elements[kept++] = elements[i];
+            if (kept == count)
+            {
+                throw std::invalid_argument("Element not found in container");
+            }
+            count = kept;
+        }
+
+        /**
+         * Returns the number of elements currently in the container.
+         */
+        constexpr size_t size() const { return count; }
+
+        /**
+         * Returns the capacity N.
+         */
+        static constexpr size_t capacity() { return N; }
+
+        /**
+         * Returns the elements in the given traversal order; entries past size() are value-initialized.
+         * Used in a constexpr variable, the result is computed by the compiler:
+         *     static constexpr auto table = make_set().to_array(TraversalOrder::Ascending);
+         * @param order ---> The traversal order.
+         */
+        constexpr std::array<T, N> to_array(TraversalOrder order) const
+        {
+            std::array<T, N> out{};
+            std::array<size_t, N> sorted{};
+            if (detail::is_value_order(order))
+                sorted = sorted_index();
+            for (size_t pos = 0; pos < count; pos++)
+                out[pos] = elements[detail::traversal_index(order, count, pos, sorted.data())];
+            return out;
+        }
+
+        /**
+         *  Prints all elements in insertion order.
+         */
+        friend std::ostream &operator<<(std::ostream &os, const StaticContainer &container)
+        {
+            for (size_t i = 0; i < container.count; i++)
+                os << container.elements[i] << " ";
+            return os;
+        }
+
+        /**
+         * @class ---> Iterator
+         * Iterator over one of the six traversal orders. The value orders keep the sorted permutation
+         * inside the iterator (N indices), so no allocation is ever made.
+         */
+        class Iterator
+        {
+        private:
+            const StaticContainer *container;
+            TraversalOrder order;
+            std::array<size_t, N> sorted; //< Sorted permutation (value orders only).
+            size_t index;
+
+        public:
+            constexpr Iterator(const StaticContainer &contain, TraversalOrder o, bool end)
+                : container(&contain), order(o), sorted{}, index(end ? contain.size() : 0)
+            {
+                if (!end && detail::is_value_order(o))
+                    sorted = contain.sorted_index();
+            }
+
+            /**
+             * Dereference operator to access current element.
+             * @throws ---> std::out_of_range if the index is beyond the end.
+             */
+            constexpr const T &operator*() const
+            {
+                size_t n = container->size();
+                if (index >= n)
+                {
+                    throw std::out_of_range("Dereferencing past-the-end iterator");
+                }
+                return container->elements[detail::traversal_index(order, n, index, sorted.data())];
+            }
+
+            constexpr Iterator &operator++()
+            {
+                index++;
+                return *this;
+            }
+
+            constexpr Iterator operator++(int)
+            {
+                Iterator temp = *this;
+                ++(*this);
+                return temp;
+            }
+
+            constexpr bool operator==(const Iterator &other) const { return index == other.index; }
+
+            /**
+             * @throws---->  std::invalid_argument if the iterators belong to different containers.
+             */
+            constexpr bool operator!=(const Iterator &other) const
+            {
+                if (container != other.container)
+                {
+                    throw std::invalid_argument("Cannot compare iterators from different containers");
+                }
+                return index != other.index;
+            }
+        };
+
+        constexpr Iterator begin_ascending_order() const { return Iterator(*this, TraversalOrder::Ascending, false); }
+        constexpr Iterator end_ascending_order() const { return Iterator(*this, TraversalOrder::Ascending, true); }
+        constexpr Iterator begin_descending_order() const { return Iterator(*this, TraversalOrder::Descending, false); }
+        constexpr Iterator end_descending_order() const { return Iterator(*this, TraversalOrder::Descending, true); }
+        constexpr Iterator begin_side_cross_order() const { return Iterator(*this, TraversalOrder::SideCross, false); }
+        constexpr Iterator end_side_cross_order() const { return Iterator(*this, TraversalOrder::SideCross, true); }
+        constexpr Iterator begin_reverse_order() const { return Iterator(*this, TraversalOrder::Reverse, false); }
+        constexpr Iterator end_reverse_order() const { return Iterator(*this, TraversalOrder::Reverse, true); }
+        constexpr Iterator begin_order() const { return Iterator(*this, TraversalOrder::Insertion, false); }
+        constexpr Iterator end_order() const { return Iterator(*this, TraversalOrder::Insertion, true); }
+        constexpr Iterator begin_middle_out_order() const { return Iterator(*this, TraversalOrder::MiddleOut, false); }
+        constexpr Iterator end_middle_out_order() const { return Iterator(*this, TraversalOrder::MiddleOut, true); }
+    };
+}
+#endif
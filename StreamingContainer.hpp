@@ -0,0 +1,316 @@
+//ronamsalem4@gmail.com
+#ifndef __STREAMINGCONTAINER_HPP
+#define __STREAMINGCONTAINER_HPP
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <optional>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <stdexcept>
+/**
+ * A container for pipelines in which producers keep adding elements while a consumer wants them
+ * in ascending order as early as possible.
+ * Producers append through a bounded lock-free multi-producer queue (no lock on the hot path).
+ * The consumer drains the queue into sorted runs, which are merged so that only O(log n) runs exist,
+ * and emits the smallest pending element as soon as it is final.
+ * An element is final when it is below the watermark: by calling advance_watermark(w) the producer
+ * side promises that no element smaller than w will be added any more. close() ends the stream and
+ * makes every element final. With several producers the watermark must be the minimum of their progress.
+ */
+
+namespace ariel
+{
+    namespace detail
+    {
+        /**
+         * Bounded multi-producer queue (Dmitry Vyukov's array queue). Every cell carries a sequence
+         * number telling whether it is free for the producer of a position or full for the consumer,
+         * so producers only contend on one atomic increment. Used here with a single consumer.
+         */
+        template <typename T>
+        class BoundedQueue
+        {
+        private:
+            struct Cell
+            {
+                std::atomic<size_t> sequence;
+                T value;
+            };
+
+            std::unique_ptr<Cell[]> cells;
+            size_t mask;
+            alignas(64) std::atomic<size_t> enqueue_pos{0};
+            alignas(64) std::atomic<size_t> dequeue_pos{0};
+
+        public:
+            /**
+             * @param capacity ---> Rounded up to a power of two (at least 2).
+             */
+            explicit BoundedQueue(size_t capacity)
+            {
+                size_t size = 2;
+                while (size < capacity)
+                    size *= 2;
+                cells = std::make_unique<Cell[]>(size);
+                mask = size - 1;
+                for (size_t i = 0; i < size; i++)
+                    cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+
+            /**
+             * Appends a value; safe to call from any number of threads.
+             * @return ---> False if the queue is full.
+             */
+            bool try_push(const T &val)
+            {
+                size_t pos = enqueue_pos.load(std::memory_order_relaxed);
+                Cell *cell;
+                for (;;)
+                {
+                    cell = &cells[pos & mask];
+                    size_t seq = cell->sequence.load(std::memory_order_acquire);
+                    auto diff = static_cast<std::intptr_t>(seq) - static_cast<std::intptr_t>(pos);
+                    if (diff == 0)
+                    {
+                        if (enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                            break;
+                    }
+                    else if (diff < 0)
+                        return false;
+                    else
+                        pos = enqueue_pos.load(std::memory_order_relaxed);
+                }
+                cell->value = val;
+                cell->sequence.store(pos + 1, std::memory_order_release);
+                return true;
+            }
+
+            /**
+             * Takes the oldest value; must only be called from the consumer thread.
+             * @return ---> False if the queue is empty (or its oldest value is still being written).
+             */
+            bool try_pop(T &out)
+            {
+                size_t pos = dequeue_pos.load(std::memory_order_relaxed);
+                Cell &cell = cells[pos & mask];
+                size_t seq = cell.sequence.load(std::memory_order_acquire);
+                if (seq != pos + 1)
+                    return false;
+                dequeue_pos.store(pos + 1, std::memory_order_relaxed);
+                out = std::move(cell.value);
+                cell.sequence.store(pos + mask + 1, std::memory_order_release);
+                return true;
+            }
+        };
+    }
+
+    /**
+     * @class ---> StreamingContainer
+     * @tparam ---> T The type of elements (default constructible and copy assignable).
+     * @tparam ---> Compare Strict weak ordering of the elements. Defaults to std::less<>.
+     */
+    template <typename T = int, typename Compare = std::less<>>
+    class StreamingContainer
+    {
+    private:
+        struct Run
+        {
+            std::vector<T> values; //< Sorted.
+            size_t next = 0;       //< First value not emitted yet.
+
+            size_t remaining() const { return values.size() - next; }
+        };
+
+        detail::BoundedQueue<T> queue;
+        [[no_unique_address]] Compare comp;
+        std::atomic<bool> closed{false};
+        std::atomic<size_t> received{0};
+        mutable std::mutex watermark_mutex;
+        std::optional<T> watermark; //< No element below it will be added.
+
+        // Consumer side.
+        std::vector<Run> runs; //< Sizes decrease from the first run to the last.
+        std::vector<T> incoming;
+        std::optional<T> emitted_bound; //< Watermark in force at the last emission.
+        size_t emitted = 0;
+        size_t rejected = 0; //< Elements dropped because they arrived below the watermark.
+
+        /**
+         * Moves the queued elements into a new sorted run (see add_run).
+         * Elements that arrived below an already published watermark cannot be emitted in order any more:
+         * they are dropped (counted in rejected), the others are kept, and then the error is reported.
+         * @throws ---> std::logic_error if an element arrived below an already published watermark.
+         */
+        void drain()
+        {
+            std::erase_if(runs, [](const Run &run)
+                          { return run.remaining() == 0; });
+            T val;
+            while (queue.try_pop(val))
+                incoming.push_back(std::move(val));
+            if (incoming.empty())
+                return;
+            std::sort(incoming.begin(), incoming.end(), std::ref(comp));
+            size_t late = 0;
+            if (emitted_bound)
+                late = static_cast<size_t>(std::lower_bound(incoming.begin(), incoming.end(), *emitted_bound, std::ref(comp)) - incoming.begin());
+            incoming.erase(incoming.begin(), incoming.begin() + static_cast<std::ptrdiff_t>(late));
+            rejected += late;
+            if (!incoming.empty())
+                add_run();
+            if (late > 0)
+            {
+                throw std::logic_error("Element added below the watermark");
+            }
+        }
+
+        /**
+         * Turns the sorted incoming elements into a run and restores the run invariant by merging the
+         * newest run into its predecessor while it is at least half as large (as in timsort), which
+         * keeps the number of runs logarithmic.
+         */
+        void add_run()
+        {
+            runs.push_back(Run{std::move(incoming), 0});
+            incoming.clear();
+            while (runs.size() > 1 && 2 * runs.back().remaining() >= runs[runs.size() - 2].remaining())
+            {
+                Run &low = runs[runs.size() - 2];
+                Run &high = runs.back();
+                std::vector<T> merged;
+                merged.reserve(low.remaining() + high.remaining());
+                std::merge(low.values.begin() + static_cast<std::ptrdiff_t>(low.next), low.values.end(),
+                           high.values.begin() + static_cast<std::ptrdiff_t>(high.next), high.values.end(),
+                           std::back_inserter(merged), std::ref(comp));
+                runs.pop_back();
+                runs.back() = Run{std::move(merged), 0};
+            }
+        }
+
+    public:
+        /**
+         * Creates an empty, open stream.
+         * @param queue_capacity ---> Capacity of the producer queue (rounded up to a power of two).
+         * @param compare ---> The ordering.
+         */
+        explicit StreamingContainer(size_t queue_capacity = 1024, Compare compare = Compare())
+            : queue(queue_capacity), comp(std::move(compare)) {}
+
+        /**
+         * Adds an element without blocking. Safe to call from several producer threads.
+         * @return ---> False if the queue is full (the consumer has not caught up).
+         * @throws ---> std::logic_error if the stream is closed.
+         */
+        bool try_push(const T &val)
+        {
+            if (closed.load(std::memory_order_acquire))
+            {
+                throw std::logic_error("Stream is closed");
+            }
+            if (!queue.try_push(val))
+                return false;
+            received.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+
+        /**
+         * Adds an element, yielding while the queue is full. Safe to call from several producer threads.
+         * @param val ---> The element to be added.
+         * @throws ---> std::logic_error if the stream is closed.
+         */
+        void addElement(const T &val)
+        {
+            while (!try_push(val))
+                std::this_thread::yield();
+        }
+
+        /**
+         * Promises that no element smaller than w will be added any more; the elements below w become
+         * final. A watermark lower than the current one is ignored.
+         */
+        void advance_watermark(const T &w)
+        {
+            std::lock_guard<std::mutex> lock(watermark_mutex);
+            if (!watermark || std::invoke(comp, *watermark, w))
+                watermark = w;
+        }
+
+        /**
+         * Ends the stream: no element will be added any more and every element is final.
+         * Call it after all producers have finished.
+         */
+        void close() { closed.store(true, std::memory_order_release); }
+
+        /**
+         * Returns the number of elements added so far.
+         */
+        size_t size() const { return received.load(std::memory_order_relaxed); }
+
+        /**
+         * Returns the number of sorted runs currently kept by the consumer.
+         */
+        size_t run_count() const { return runs.size(); }
+
+        /**
+         * Consumer: returns the next element of the ascending stream if it is final, otherwise std::nullopt
+         * (more data or a higher watermark is needed; see exhausted()).
+         * @throws ---> std::logic_error if a producer added an element below a published watermark. Such
+         * elements are dropped and the stream stays usable: the next call continues with the others.
+         */
+        std::optional<T> next()
+        {
+            bool done = closed.load(std::memory_order_acquire);
+            std::optional<T> bound;
+            if (!done)
+            {
+                std::lock_guard<std::mutex> lock(watermark_mutex);
+                bound = watermark;
+            }
+            // Drain even without a watermark, so producers that fill the queue first do not wait forever.
+            // The watermark is read before draining: elements added below it are then in the queue.
+            drain();
+            if (!done && !bound)
+                return std::nullopt;
+            Run *best = nullptr;
+            for (Run &run : runs)
+                if (run.remaining() > 0 && (!best || std::invoke(comp, run.values[run.next], best->values[best->next])))
+                    best = &run;
+            if (!best || (!done && !std::invoke(comp, best->values[best->next], *bound)))
+                return std::nullopt;
+            if (bound)
+                emitted_bound = std::move(bound);
+            T val = std::move(best->values[best->next++]);
+            emitted++;
+            return val;
+        }
+
+        /**
+         * Consumer: calls fn on every element that is final now, in ascending order.
+         * @return ---> The number of elements passed to fn.
+         */
+        template <typename Fn>
+        size_t consume(Fn fn)
+        {
+            size_t count = 0;
+            while (auto val = next())
+            {
+                fn(*val);
+                count++;
+            }
+            return count;
+        }
+
+        /**
+         * Consumer: true when the stream is closed and every element has been emitted.
+         */
+        bool exhausted() const
+        {
+            return closed.load(std::memory_order_acquire) && emitted + rejected == received.load(std::memory_order_acquire);
+        }
+    };
+}
+#endif
@@ -0,0 +1,260 @@
+//ronamsalem4@gmail.com
+#ifndef __STRINGCONTAINER_HPP
+#define __STRINGCONTAINER_HPP
+#include "MyContainer.hpp"
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstring>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+/**
+ * A container specialized for many short strings.
+ * StringContainer keeps the characters of all strings in one contiguous arena and describes every
+ * string by an (offset, length) record, so there is no heap allocation per string and no copy of
+ * the strings when iterating. It has the same interface as MyContainer<std::string>, but its
+ * iterators yield std::string_view into the arena.
+ * The value orders are built with a multikey quicksort (three-way radix quicksort), which looks at
+ * every character at most a few times instead of comparing whole strings again and again.
+ * The sorted permutation is computed once and kept until the next modification.
+ * Any modification invalidates the iterators and the views they returned; dereferencing such an
+ * iterator throws std::logic_error.
+ */
+
+namespace ariel
+{
+    /**
+     * @class ---> StringContainer
+     * An arena-backed container of strings.
+     */
+    class StringContainer
+    {
+    private:
+        struct Record
+        {
+            size_t offset; //< First character in the arena.
+            size_t length; //< Number of characters.
+        };
+
+        std::string arena;                  //< Characters of all strings, in insertion order.
+        std::vector<Record> records;        //< One record per element, in insertion order.
+        mutable std::vector<size_t> sorted; //< Ascending permutation of the records.
+        mutable bool sorted_valid = false;  //< False after every modification.
+        std::uint64_t modifications = 0;    //< Incremented by every modification (checked by the iterators).
+
+        static constexpr size_t INSERTION_SORT_MAX = 16; //< Small ranges are finished with insertion sort.
+
+        std::string_view view(size_t i) const { return std::string_view(arena.data() + records[i].offset, records[i].length); }
+
+        /**
+         * Character of record i at the given depth, 0 past the end (so shorter strings come first).
+         */
+        int char_at(size_t i, size_t depth) const
+        {
+            return depth < records[i].length ? static_cast<unsigned char>(arena[records[i].offset + depth]) + 1 : 0;
+        }
+
+        /**
+         * Sorts idx[lo, hi), whose strings all share their first `depth` characters.
+         */
+        void multikey_sort(size_t *idx, size_t lo, size_t hi, size_t depth) const
+        {
+            while (hi - lo > INSERTION_SORT_MAX)
+            {
+                int pivot = char_at(idx[lo + (hi - lo) / 2], depth);
+                size_t lt = lo, gt = hi, i = lo;
+                while (i < gt)
+                {
+                    int c = char_at(idx[i], depth);
+                    if (c < pivot)
+                        std::swap(idx[lt++], idx[i++]);
+                    else if (c > pivot)
+                        std::swap(idx[i], idx[--gt]);
+                    else
+                        i++;
+                }
+                multikey_sort(idx, lo, lt, depth);
+                multikey_sort(idx, gt, hi, depth);
+                if (pivot == 0)
+                    return;
+                lo = lt;
+                hi = gt;
+                depth++;
+            }
+            for (size_t i = lo + 1; i < hi; i++)
+            {
+                size_t current = idx[i];
+                std::string_view suffix = view(current).substr(std::min(depth, records[current].length));
+                size_t j = i;
+                while (j > lo && suffix < view(idx[j - 1]).substr(std::min(depth, records[idx[j - 1]].length)))
+                {
+                    idx[j] = idx[j - 1];
+                    j--;
+                }
+                idx[j] = current;
+            }
+        }
+
+        const std::vector<size_t> &sorted_index() const
+        {
+            if (!sorted_valid)
+            {
+                sorted.resize(records.size());
+                for (size_t i = 0; i < sorted.size(); i++)
+                    sorted[i] = i;
+                multikey_sort(sorted.data(), 0, sorted.size(), 0);
+                sorted_valid = true;
+            }
+            return sorted;
+        }
+
+    public:
+        /**
+         *  Adds a string to the container (its characters are appended to the arena).
+         * @param val ---> The string to be added.
+         */
+        void addElement(std::string_view val)
+        {
+            records.push_back(Record{arena.size(), val.size()});
+            arena.append(val);
+            sorted_valid = false;
+            modifications++;
+        }
+
+        /**
+         * Removes all occurrences of a string and compacts the arena in place.
+         * @param val ---> The string to be removed.
+         * @throws ---> std::invalid_argument if the element is not found.
+         */
+        void removeElement(std::string_view val)
+        {
+            size_t kept = 0, write = 0;
+            for (size_t i = 0; i < records.size(); i++)
+            {
+                if (view(i) == val)
+                    continue;
+                Record r = records[i];
+                if (write != r.offset)
+                    std::memmove(arena.data() + write, arena.data() + r.offset, r.length);
+                records[kept++] = Record{write, r.length};
+                write += r.length;
+            }
+            if (kept == records.size())
+            {
+                throw std::invalid_argument("Element not found in container");
+            }
+            records.resize(kept);
+            arena.resize(write);
+            sorted_valid = false;
+            modifications++;
+        }
+
+        /**
+         * Returns the number of strings currently in the container.
+         */
+        size_t size() const { return records.size(); }
+
+        /**
+         * Returns the total number of characters stored in the arena.
+         */
+        size_t arena_size() const { return arena.size(); }
+
+        /**
+         *  Prints all strings in insertion order.
+         */
+        friend std::ostream &operator<<(std::ostream &os, const StringContainer &container)
+        {
+            for (size_t i = 0; i < container.records.size(); i++)
+                os << container.view(i) << " ";
+            return os;
+        }
+
+        /**
+         * @class ---> Iterator
+         * Iterator over one of the six traversal orders. It stores no copy of the strings: every
+         * position is mapped to a record (through the sorted permutation for the value orders) and
+         * dereferenced as a std::string_view into the arena.
+         * The size and the modification count are captured at construction, so an iterator never maps a
+         * position through a permutation of another size.
+         */
+        class Iterator
+        {
+        private:
+            const StringContainer *container;
+            TraversalOrder order;
+            const size_t *sorted; //< Sorted permutation (value orders only).
+            size_t count;         //< Number of strings when the iterator was created.
+            std::uint64_t modifications;
+            size_t index;
+
+        public:
+            Iterator(const StringContainer &contain, TraversalOrder o, bool end)
+                : container(&contain), order(o), sorted(nullptr), count(contain.size()),
+                  modifications(contain.modifications), index(end ? contain.size() : 0)
+            {
+                if (!end && detail::is_value_order(o))
+                    sorted = contain.sorted_index().data();
+            }
+
+            /**
+             * Dereference operator to access current string.
+             * @throws ---> std::out_of_range if the index is beyond the end, std::logic_error if the
+             * container was modified after the iterator was created.
+             */
+            std::string_view operator*() const
+            {
+                if (modifications != container->modifications)
+                {
+                    throw std::logic_error("Iterator used after its container was modified");
+                }
+                if (index >= count)
+                {
+                    throw std::out_of_range("Dereferencing past-the-end iterator");
+                }
+                return container->view(detail::traversal_index(order, count, index, sorted));
+            }
+
+            Iterator &operator++()
+            {
+                index++;
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator temp = *this;
+                ++(*this);
+                return temp;
+            }
+
+            bool operator==(const Iterator &other) const { return index == other.index; }
+
+            /**
+             * @throws---->  std::invalid_argument if the iterators belong to different containers.
+             */
+            bool operator!=(const Iterator &other) const
+            {
+                if (container != other.container)
+                {
+                    throw std::invalid_argument("Cannot compare iterators from different containers");
+                }
+                return index != other.index;
+            }
+        };
+
+        Iterator begin_ascending_order() const { return Iterator(*this, TraversalOrder::Ascending, false); }
+        Iterator end_ascending_order() const { return Iterator(*this, TraversalOrder::Ascending, true); }
+        Iterator begin_descending_order() const { return Iterator(*this, TraversalOrder::Descending, false); }
+        Iterator end_descending_order() const { return Iterator(*this, TraversalOrder::Descending, true); }
+        Iterator begin_side_cross_order() const { return Iterator(*this, TraversalOrder::SideCross, false); }
+        Iterator end_side_cross_order() const { return Iterator(*this, TraversalOrder::SideCross, true); }
+        Iterator begin_reverse_order() const { return Iterator(*this, TraversalOrder::Reverse, false); }
+        Iterator end_reverse_order() const { return Iterator(*this, TraversalOrder::Reverse, true); }
+        Iterator begin_order() const { return Iterator(*this, TraversalOrder::Insertion, false); }
+        Iterator end_order() const { return Iterator(*this, TraversalOrder::Insertion, true); }
+        Iterator begin_middle_out_order() const { return Iterator(*this, TraversalOrder::MiddleOut, false); }
+        Iterator end_middle_out_order() const { return Iterator(*this, TraversalOrder::MiddleOut, true); }
+    };
+}
+#endif
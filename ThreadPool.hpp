@@ -0,0 +1,249 @@
+//ronamsalem4@gmail.com
+#ifndef __THREADPOOL_HPP
+#define __THREADPOOL_HPP
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <functional>
+#include <exception>
+#include <algorithm>
+#include <condition_variable>
+/**
+ * A small work-stealing thread pool used by the parallel algorithms of MyContainer.
+ * Every worker owns a deque of tasks. A worker pushes and pops its own tasks at the back (LIFO, good
+ * locality for recursive splitting) and, when it runs out of work, steals from the front of the other
+ * deques (FIFO, so the thief takes the biggest pieces). The thread that waits for a parallel_for first
+ * executes queued tasks, so nested or single-core use cannot deadlock, and sleeps only once every
+ * remaining range is already running on another thread.
+ */
+
+namespace ariel
+{
+    /**
+     * @class ---> WorkStealingPool
+     * Fixed-size pool of worker threads with one task deque per worker.
+     */
+    class WorkStealingPool
+    {
+    private:
+        using Task = std::function<void()>;
+
+        struct Queue
+        {
+            std::deque<Task> tasks;
+            std::mutex mutex;
+        };
+
+        std::vector<std::unique_ptr<Queue>> queues; //< One deque per worker.
+        std::vector<std::thread> threads;
+        std::atomic<size_t> pending{0};             //< Number of queued tasks.
+        std::atomic<size_t> next_queue{0};          //< Round robin for tasks submitted from outside.
+        std::atomic<bool> stopping{false};
+        std::mutex idle_mutex;
+        std::condition_variable idle;
+
+        /**
+         * Index of the worker running on the calling thread, or -1 for threads that are not workers of this pool.
+         */
+        long self_index() const
+        {
+            return (current_pool() == this) ? current_worker() : -1;
+        }
+
+        static const WorkStealingPool *&current_pool()
+        {
+            thread_local const WorkStealingPool *pool = nullptr;
+            return pool;
+        }
+
+        static long &current_worker()
+        {
+            thread_local long worker = -1;
+            return worker;
+        }
+
+        /**
+         * Takes one task: the newest one of the own deque, otherwise the oldest one of another deque.
+         */
+        bool take(long self, Task &task)
+        {
+            size_t count = queues.size();
+            if (self >= 0)
+            {
+                Queue &own = *queues[static_cast<size_t>(self)];
+                std::lock_guard<std::mutex> lock(own.mutex);
+                if (!own.tasks.empty())
+                {
+                    task = std::move(own.tasks.back());
+                    own.tasks.pop_back();
+                    pending--;
+                    return true;
+                }
+            }
+            size_t start = (self >= 0) ? static_cast<size_t>(self) + 1 : next_queue.load();
+            for (size_t k = 0; k < count; k++)
+            {
+                Queue &victim = *queues[(start + k) % count];
+                std::lock_guard<std::mutex> lock(victim.mutex);
+                if (!victim.tasks.empty())
+                {
+                    task = std::move(victim.tasks.front());
+                    victim.tasks.pop_front();
+                    pending--;
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        void work(long self)
+        {
+            current_pool() = this;
+            current_worker() = self;
+            Task task;
+            while (!stopping)
+            {
+                if (take(self, task))
+                {
+                    task();
+                    task = nullptr;
+                    continue;
+                }
+                std::unique_lock<std::mutex> lock(idle_mutex);
+                idle.wait(lock, [this]
+                          { return stopping || pending > 0; });
+            }
+        }
+
+    public:
+        /**
+         * Starts the worker threads.
+         * @param count ---> Number of workers. Defaults to the number of hardware threads.
+         */
+        explicit WorkStealingPool(size_t count = std::max(1u, std::thread::hardware_concurrency()))
+        {
+            count = std::max<size_t>(1, count);
+            for (size_t i = 0; i < count; i++)
+                queues.push_back(std::make_unique<Queue>());
+            for (size_t i = 0; i < count; i++)
+                threads.emplace_back(&WorkStealingPool::work, this, static_cast<long>(i));
+        }
+
+        WorkStealingPool(const WorkStealingPool &) = delete;
+        WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+        ~WorkStealingPool()
+        {
+            {
+                std::lock_guard<std::mutex> lock(idle_mutex);
+                stopping = true;
+            }
+            idle.notify_all();
+            for (auto &thread : threads)
+                thread.join();
+        }
+
+        /**
+         * Returns the pool shared by all containers (created on first use).
+         */
+        static WorkStealingPool &instance()
+        {
+            static WorkStealingPool pool;
+            return pool;
+        }
+
+        /**
+         * Returns the number of worker threads.
+         */
+        size_t size() const { return threads.size(); }
+
+        /**
+         * Queues a task. From a worker it goes to the worker's own deque, otherwise to the next deque in turn.
+         * @param task ---> The task to run.
+         */
+        void submit(Task task)
+        {
+            long self = self_index();
+            size_t target = (self >= 0) ? static_cast<size_t>(self) : next_queue++ % queues.size();
+            {
+                std::lock_guard<std::mutex> lock(queues[target]->mutex);
+                queues[target]->tasks.push_back(std::move(task));
+                pending++;
+            }
+            {
+                std::lock_guard<std::mutex> lock(idle_mutex);
+            }
+            idle.notify_one();
+        }
+
+        /**
+         * Calls body(lo, hi) on disjoint ranges covering [begin, end), in parallel.
+         * Ranges are split in halves until they are at most `grain` long; the halves are queued so idle
+         * workers can steal them. The calling thread takes part in the work; once nothing is left to take it
+         * blocks until the last running range signals that it is done.
+         * @param begin ---> First index.
+         * @param end ---> One past the last index.
+         * @param grain ---> Largest range handed to body (at least 1).
+         * @param body ---> Called as body(size_t lo, size_t hi).
+         * @throws ---> The first exception thrown by body, after all ranges have finished.
+         */
+        template <typename Body>
+        void parallel_for(size_t begin, size_t end, size_t grain, const Body &body)
+        {
+            if (begin >= end)
+                return;
+            grain = std::max<size_t>(1, grain);
+            std::atomic<size_t> remaining{end - begin};
+            std::exception_ptr error;
+            std::mutex error_mutex;
+            std::mutex done_mutex;
+            std::condition_variable done;
+
+            std::function<void(size_t, size_t)> run = [&](size_t lo, size_t hi)
+            {
+                while (hi - lo > grain)
+                {
+                    size_t mid = lo + (hi - lo) / 2;
+                    submit([&run, mid, hi]
+                           { run(mid, hi); });
+                    hi = mid;
+                }
+                try
+                {
+                    body(lo, hi);
+                }
+                catch (...)
+                {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+                // Counted under the lock so the caller cannot return (and destroy done) before the notify.
+                std::lock_guard<std::mutex> lock(done_mutex);
+                if ((remaining -= hi - lo) == 0)
+                    done.notify_all();
+            };
+
+            run(begin, end);
+            long self = self_index();
+            Task task;
+            while (remaining.load() != 0 && take(self, task))
+            {
+                task();
+                task = nullptr;
+            }
+            {
+                // Nothing left to take: the remaining ranges are running on other threads.
+                std::unique_lock<std::mutex> lock(done_mutex);
+                done.wait(lock, [&remaining]
+                          { return remaining.load() == 0; });
+            }
+            if (error)
+                std::rethrow_exception(error);
+        }
+    };
+}
+#endif
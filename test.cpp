@@ -3,9 +3,52 @@
 #include <sstream>
 #include "doctest.h"
 #include "MyContainer.hpp"
+#include "ExternalContainer.hpp"
+#include "RunLengthContainer.hpp"
+#include "StringContainer.hpp"
+#include "KeyedContainer.hpp"
+#include "StaticContainer.hpp"
+#include "StreamingContainer.hpp"
+#include "SharedContainer.hpp"
 #include <vector>
+#include <fstream>
+#include <cstdio>
+#include <filesystem>
+#include <atomic>
+#include <cmath>
+#include <new>
+#include <cstdlib>
+#include <thread>
+#include <sys/wait.h>
+#include <spawn.h>
+#include <unistd.h>
 using namespace ariel;
 
+/**
+ * Counts the heap allocations of the test binary, for the small-buffer tests.
+ */
+static std::atomic<size_t> heap_allocations{0};
+
+void *operator new(std::size_t size)
+{
+    heap_allocations++;
+    if (void *p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    heap_allocations++;
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
 /**
  * This file contains unit tests for the MyContainer class and its various iterators.
  * The tests cover insertion, removal, iteration orders, exception handling, and 
@@ -51,6 +94,7 @@ TEST_CASE("Check if specific element exists after addElement")
             break;
         }
     }
+    CHECK(found);
 }
 
 /**
@@ -635,7 +679,11 @@ TEST_CASE("Iterator stability after addElement") {
     c.addElement(1);
     auto it = c.begin_order();
     c.addElement(2); 
+#ifdef ARIEL_CHECKED_ITERATORS
+    CHECK_THROWS_AS(*it, std::logic_error);
+#else
     CHECK_NOTHROW(*it);
+#endif
 }
 
 
@@ -687,3 +735,1804 @@ TEST_CASE("Iterator copy and post-increment") {
     CHECK(*copy == 1);
     CHECK(*it == 2);
 }
+
+/**
+ * Test: export_async writes the requested traversal order to a file.
+ * Checks the text and line formats and that the returned future reports the element count.
+ */
+TEST_CASE("export_async writes the traversal order to a file") {
+    MyContainer<int> c;
+    c.addElement(7);
+    c.addElement(15);
+    c.addElement(6);
+    c.addElement(1);
+    c.addElement(2);
+    std::string path = (std::filesystem::temp_directory_path() / "ariel_export_test.txt").string();
+
+    auto done = c.export_async(path, TraversalOrder::Ascending, ExportFormat::Text);
+    CHECK(done.get() == 5);
+    std::ifstream text(path);
+    std::string line;
+    std::getline(text, line);
+    CHECK(line == "1 2 6 7 15 ");
+    text.close();
+
+    CHECK(c.export_async(path, TraversalOrder::SideCross, ExportFormat::Lines).get() == 5);
+    std::ifstream lines(path);
+    std::vector<int> result;
+    int value;
+    while (lines >> value)
+        result.push_back(value);
+    CHECK(result == std::vector<int>{1, 15, 2, 7, 6});
+    lines.close();
+    std::remove(path.c_str());
+}
+
+/**
+ * Test: export_async works on a snapshot
+ * Verifies that a large binary export is not affected by changes made after the call returns.
+ */
+TEST_CASE("export_async binary export of a snapshot") {
+    MyContainer<int> c;
+    for (int i = 20000; i > 0; --i)
+        c.addElement(i);
+    std::string path = (std::filesystem::temp_directory_path() / "ariel_export_test.bin").string();
+
+    auto done = c.export_async(path, TraversalOrder::Reverse, ExportFormat::Binary);
+    c.addElement(-1);
+    CHECK(done.get() == 20000);
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<int> result(20000);
+    in.read(reinterpret_cast<char *>(result.data()), static_cast<std::streamsize>(result.size() * sizeof(int)));
+    CHECK(in.gcount() == static_cast<std::streamsize>(20000 * sizeof(int)));
+    CHECK(result.front() == 1);
+    CHECK(result.back() == 20000);
+    in.close();
+    std::remove(path.c_str());
+}
+
+/**
+ * Test: export_async error handling
+ * Binary format needs a trivially copyable type, and an unwritable path is reported through the future.
+ */
+TEST_CASE("export_async errors") {
+    MyContainer<std::string> s;
+    s.addElement("a");
+    CHECK_THROWS_AS(s.export_async("unused.bin", TraversalOrder::Insertion, ExportFormat::Binary), std::invalid_argument);
+
+    MyContainer<int> c;
+    c.addElement(1);
+    auto done = c.export_async("/nonexistent_dir/out.txt");
+    CHECK_THROWS_AS(done.get(), std::runtime_error);
+}
+
+/**
+ * Test: ExternalContainer traversal orders
+ * With a tiny memory budget the data is spilled to several segments; every traversal order
+ * must still match the one of an in-memory MyContainer holding the same elements.
+ */
+TEST_CASE("ExternalContainer matches MyContainer in all orders") {
+    ExternalContainer<int> ext(4);
+    MyContainer<int> mem;
+    int values[] = {7, 15, 6, 1, 2, 9, 9, -3, 11, 0, 4, 8, 13, 5, 5, 21, 17, 3, -8, 12, 10, 6, 1};
+    for (int v : values) {
+        ext.addElement(v);
+        mem.addElement(v);
+    }
+    CHECK(ext.size() == mem.size());
+    CHECK(ext.segment_count() == 5);
+
+    auto collect = [](auto it, auto end) {
+        std::vector<int> out;
+        for (; it != end; ++it)
+            out.push_back(*it);
+        return out;
+    };
+    CHECK(collect(ext.begin_order(), ext.end_order()) == collect(mem.begin_order(), mem.end_order()));
+    CHECK(collect(ext.begin_reverse_order(), ext.end_reverse_order()) == collect(mem.begin_reverse_order(), mem.end_reverse_order()));
+    CHECK(collect(ext.begin_middle_out_order(), ext.end_middle_out_order()) == collect(mem.begin_middle_out_order(), mem.end_middle_out_order()));
+    CHECK(collect(ext.begin_ascending_order(), ext.end_ascending_order()) == collect(mem.begin_ascending_order(), mem.end_ascending_order()));
+    CHECK(collect(ext.begin_descending_order(), ext.end_descending_order()) == collect(mem.begin_descending_order(), mem.end_descending_order()));
+    CHECK(collect(ext.begin_side_cross_order(), ext.end_side_cross_order()) == collect(mem.begin_side_cross_order(), mem.end_side_cross_order()));
+
+    ext.removeElement(9);
+    mem.removeElement(9);
+    CHECK(ext.size() == 21);
+    CHECK(collect(ext.begin_order(), ext.end_order()) == collect(mem.begin_order(), mem.end_order()));
+    CHECK(collect(ext.begin_ascending_order(), ext.end_ascending_order()) == collect(mem.begin_ascending_order(), mem.end_ascending_order()));
+    CHECK_THROWS_AS(ext.removeElement(99), std::invalid_argument);
+
+    ext.addElement(30);
+    mem.addElement(30);
+    CHECK(collect(ext.begin_middle_out_order(), ext.end_middle_out_order()) == collect(mem.begin_middle_out_order(), mem.end_middle_out_order()));
+}
+
+/**
+ * Test: ExternalContainer keeps the runs of spilled segments
+ * Adding an element only changes the buffer, so the next sorted traversal writes one new run
+ * (the buffer's) instead of re-sorting every segment.
+ */
+TEST_CASE("ExternalContainer re-sorts only the buffer after addElement") {
+    auto dir = std::filesystem::temp_directory_path() / ("ariel_runs_" + std::to_string(getpid()));
+    std::filesystem::create_directories(dir);
+    auto files = [&dir] {
+        std::vector<std::string> out;
+        for (const auto &entry : std::filesystem::directory_iterator(dir))
+            out.push_back(entry.path().filename().string());
+        std::sort(out.begin(), out.end());
+        return out;
+    };
+    {
+        ExternalContainer<int> ext(4, dir);
+        MyContainer<int> mem;
+        for (int v : {7, 15, 6, 1, 2, 9, 9, -3, 11, 0}) {
+            ext.addElement(v);
+            mem.addElement(v);
+        }
+        auto collect = [](auto it, auto end) {
+            std::vector<int> out;
+            for (; it != end; ++it)
+                out.push_back(*it);
+            return out;
+        };
+        CHECK(collect(ext.begin_ascending_order(), ext.end_ascending_order()) == collect(mem.begin_ascending_order(), mem.end_ascending_order()));
+        auto before = files();
+        CHECK(before.size() == 5); // 2 segments, 2 segment runs, 1 buffer run
+        for (const auto &entry : std::filesystem::directory_iterator(dir))
+            CHECK((entry.status().permissions() & std::filesystem::perms::all) == (std::filesystem::perms::owner_read | std::filesystem::perms::owner_write));
+
+        ext.addElement(4);
+        mem.addElement(4);
+        CHECK(collect(ext.begin_descending_order(), ext.end_descending_order()) == collect(mem.begin_descending_order(), mem.end_descending_order()));
+        auto after = files();
+        std::vector<std::string> created;
+        std::set_difference(after.begin(), after.end(), before.begin(), before.end(), std::back_inserter(created));
+        CHECK(created.size() == 1);
+        CHECK(after.size() == 5);
+
+        ext.addElement(3); // spills a third segment
+        mem.addElement(3);
+        CHECK(collect(ext.begin_side_cross_order(), ext.end_side_cross_order()) == collect(mem.begin_side_cross_order(), mem.end_side_cross_order()));
+        CHECK(files().size() == 6);
+        ext.removeElement(9);
+        mem.removeElement(9);
+        CHECK(collect(ext.begin_ascending_order(), ext.end_ascending_order()) == collect(mem.begin_ascending_order(), mem.end_ascending_order()));
+    }
+    CHECK(files().empty());
+    std::filesystem::remove(dir);
+}
+
+/**
+ * Test: ExternalContainer edge cases
+ * An empty container has begin == end for every order, and dereferencing end throws.
+ */
+TEST_CASE("ExternalContainer empty and single element") {
+    ExternalContainer<double> ext(2);
+    CHECK(ext.begin_ascending_order() == ext.end_ascending_order());
+    CHECK(ext.begin_middle_out_order() == ext.end_middle_out_order());
+    CHECK_THROWS_AS(*ext.begin_order(), std::out_of_range);
+    CHECK_THROWS_AS(ExternalContainer<int>(0), std::invalid_argument);
+
+    ext.addElement(2.5);
+    CHECK(*ext.begin_side_cross_order() == 2.5);
+    std::ostringstream out;
+    out << ext;
+    CHECK(out.str() == "2.5 ");
+}
+
+/**
+ * Test: RunLengthContainer value-ordered views
+ * Duplicates are stored as counts, but the ascending, descending and side-cross traversals must
+ * expand them exactly like MyContainer does.
+ */
+TEST_CASE("RunLengthContainer expands counts like MyContainer") {
+    RunLengthContainer<int> rle;
+    MyContainer<int> mem;
+    int values[] = {4, 15, 4, 1, 4, 7, 15, 1, 4, 9, 7};
+    for (int v : values) {
+        rle.addElement(v);
+        mem.addElement(v);
+    }
+    CHECK(rle.size() == 11);
+    CHECK(rle.distinct_count() == 5);
+    CHECK(rle.count(4) == 4);
+    CHECK(rle.count(3) == 0);
+
+    auto collect = [](auto it, auto end) {
+        std::vector<int> out;
+        for (; it != end; ++it)
+            out.push_back(*it);
+        return out;
+    };
+    CHECK(collect(rle.begin_ascending_order(), rle.end_ascending_order()) == collect(mem.begin_ascending_order(), mem.end_ascending_order()));
+    CHECK(collect(rle.begin_descending_order(), rle.end_descending_order()) == collect(mem.begin_descending_order(), mem.end_descending_order()));
+    CHECK(collect(rle.begin_side_cross_order(), rle.end_side_cross_order()) == collect(mem.begin_side_cross_order(), mem.end_side_cross_order()));
+
+    rle.removeElement(4);
+    CHECK(rle.size() == 7);
+    CHECK(collect(rle.begin_side_cross_order(), rle.end_side_cross_order()) == std::vector<int>{1, 15, 1, 15, 7, 9, 7});
+    CHECK_THROWS_AS(rle.removeElement(4), std::invalid_argument);
+
+    std::ostringstream out;
+    out << rle;
+    CHECK(out.str() == "1 1 7 7 9 15 15 ");
+}
+
+/**
+ * Test: RunLengthContainer empty container
+ */
+TEST_CASE("RunLengthContainer empty container") {
+    RunLengthContainer<std::string> rle;
+    CHECK(rle.begin_ascending_order() == rle.end_ascending_order());
+    CHECK(rle.begin_side_cross_order() == rle.end_side_cross_order());
+    CHECK_THROWS_AS(*rle.begin_descending_order(), std::out_of_range);
+
+    // Incrementing an end iterator is safe, on an empty and on a non-empty container.
+    auto end = rle.end_ascending_order();
+    ++end;
+    CHECK_THROWS_AS(*end, std::out_of_range);
+    rle.addElement("b");
+    rle.addElement("a");
+    auto last = rle.begin_side_cross_order();
+    ++last;
+    ++last;
+    CHECK(last == rle.end_side_cross_order());
+    ++last;
+    last++;
+    CHECK_THROWS_AS(*last, std::out_of_range);
+    auto past = rle.end_ascending_order();
+    ++past;
+    CHECK(past != rle.end_ascending_order());
+}
+
+/**
+ * A small record type used to check ordering by one field (projection).
+ */
+struct Employee {
+    std::string name;
+    int age;
+    bool operator==(const Employee &other) const { return name == other.name && age == other.age; }
+};
+std::ostream &operator<<(std::ostream &os, const Employee &e) { return os << e.name << ":" << e.age; }
+
+/**
+ * Test: Comparator and projection template parameters
+ * Records are ordered by a field without a wrapper type; equal keys keep insertion order when ascending
+ * and the descending traversal is the exact reverse of the ascending one.
+ */
+TEST_CASE("MyContainer with a projection orders records by a field") {
+    MyContainer<Employee, std::less<>, int Employee::*> c(std::less<>(), &Employee::age);
+    c.addElement({"dana", 41});
+    c.addElement({"avi", 29});
+    c.addElement({"noa", 35});
+    c.addElement({"tal", 29});
+
+    std::vector<std::string> names;
+    for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it)
+        names.push_back((*it).name);
+    CHECK(names == std::vector<std::string>{"avi", "tal", "noa", "dana"});
+
+    names.clear();
+    for (auto it = c.begin_descending_order(); it != c.end_descending_order(); ++it)
+        names.push_back((*it).name);
+    CHECK(names == std::vector<std::string>{"dana", "noa", "tal", "avi"});
+
+    names.clear();
+    for (auto it = c.begin_side_cross_order(); it != c.end_side_cross_order(); ++it)
+        names.push_back((*it).name);
+    CHECK(names == std::vector<std::string>{"avi", "dana", "tal", "noa"});
+}
+
+/**
+ * Test: Custom comparator
+ * With std::greater the ascending traversal goes from the largest to the smallest value.
+ */
+TEST_CASE("MyContainer with std::greater comparator") {
+    MyContainer<int, std::greater<>> c;
+    c.addElement(3);
+    c.addElement(9);
+    c.addElement(1);
+    std::vector<int> result;
+    for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it)
+        result.push_back(*it);
+    CHECK(result == std::vector<int>{9, 3, 1});
+}
+
+/**
+ * Test: Sort kernels agree with a reference sort
+ * Large integral containers take the radix kernel and doubles take the key/index kernel;
+ * both must give the same result as std::stable_sort.
+ */
+TEST_CASE("Sort kernels agree with std::stable_sort") {
+    MyContainer<long> ints;
+    MyContainer<int, std::greater<>> ints_desc;
+    MyContainer<double> doubles;
+    std::vector<long> ref_ints;
+    std::vector<double> ref_doubles;
+    unsigned seed = 12345;
+    for (int i = 0; i < 1000; i++) {
+        seed = seed * 1103515245u + 12345u;
+        long value = static_cast<long>(seed % 2001) - 1000;
+        ints.addElement(value * 1000003L);
+        ints_desc.addElement(static_cast<int>(value));
+        doubles.addElement(value / 7.0);
+        ref_ints.push_back(value * 1000003L);
+        ref_doubles.push_back(value / 7.0);
+    }
+    std::stable_sort(ref_ints.begin(), ref_ints.end());
+    std::stable_sort(ref_doubles.begin(), ref_doubles.end());
+
+    std::vector<long> got_ints;
+    for (auto it = ints.begin_ascending_order(); it != ints.end_ascending_order(); ++it)
+        got_ints.push_back(*it);
+    CHECK(got_ints == ref_ints);
+
+    std::vector<int> got_desc;
+    for (auto it = ints_desc.begin_ascending_order(); it != ints_desc.end_ascending_order(); ++it)
+        got_desc.push_back(*it);
+    CHECK(std::is_sorted(got_desc.begin(), got_desc.end(), std::greater<>()));
+
+    std::vector<double> got_doubles;
+    for (auto it = doubles.begin_ascending_order(); it != doubles.end_ascending_order(); ++it)
+        got_doubles.push_back(*it);
+    CHECK(got_doubles == ref_doubles);
+}
+
+/**
+ * A type with a user-supplied cached sort key (major/minor packed into one integer).
+ */
+struct Version {
+    int major;
+    int minor;
+    bool operator<(const Version &other) const { return major < other.major || (major == other.major && minor < other.minor); }
+    bool operator==(const Version &other) const { return major == other.major && minor == other.minor; }
+};
+std::ostream &operator<<(std::ostream &os, const Version &v) { return os << v.major << "." << v.minor; }
+
+template <>
+struct ariel::sort_key<Version> {
+    static constexpr bool enabled = true;
+    static constexpr bool exact = true;
+    static std::uint64_t make(const Version &v) {
+        return (static_cast<std::uint64_t>(static_cast<std::uint32_t>(v.major) ^ 0x80000000u) << 32) |
+               (static_cast<std::uint32_t>(v.minor) ^ 0x80000000u);
+    }
+};
+
+/**
+ * Test: Cached string prefix keys
+ * Strings that share long prefixes, embedded zero bytes and empty strings must still be sorted exactly
+ * like std::stable_sort, in both directions.
+ */
+TEST_CASE("Cached prefix keys sort strings correctly") {
+    std::vector<std::string> words = {"identifier_0042", "identifier_0007", "id", "", "identifier_0042",
+                                      "zeta", "identifiers", std::string("a\0b", 3), "a", "ID", "identifier_"};
+    MyContainer<std::string> c;
+    MyContainer<std::string, std::greater<>> desc;
+    for (const auto &w : words) {
+        c.addElement(w);
+        desc.addElement(w);
+    }
+    std::vector<std::string> expected = words;
+    std::stable_sort(expected.begin(), expected.end());
+    std::vector<std::string> got;
+    for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it)
+        got.push_back(*it);
+    CHECK(got == expected);
+
+    got.clear();
+    for (auto it = desc.begin_ascending_order(); it != desc.end_ascending_order(); ++it)
+        got.push_back(*it);
+    std::reverse(expected.begin(), expected.end());
+    CHECK(got == expected);
+}
+
+/**
+ * Test: User-supplied sort key
+ * A sort_key specialization is used for the element type itself.
+ */
+TEST_CASE("User-supplied sort key") {
+    MyContainer<Version> c;
+    c.addElement({2, 1});
+    c.addElement({-1, 5});
+    c.addElement({2, 0});
+    c.addElement({1, 9});
+    std::vector<Version> got;
+    for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it)
+        got.push_back(*it);
+    CHECK(got == std::vector<Version>{{-1, 5}, {1, 9}, {2, 0}, {2, 1}});
+}
+
+/**
+ * Test: StringContainer matches MyContainer<std::string>
+ * The arena container must produce the same six traversal orders, with enough strings sharing
+ * prefixes to exercise the multikey quicksort partitions.
+ */
+TEST_CASE("StringContainer matches MyContainer<std::string> in all orders") {
+    StringContainer arena;
+    MyContainer<std::string> mem;
+    unsigned seed = 7;
+    for (int i = 0; i < 300; i++) {
+        seed = seed * 1103515245u + 12345u;
+        std::string id = "user_" + std::to_string(seed % 97);
+        if (i % 5 == 0)
+            id += std::string(1, static_cast<char>('a' + seed % 26)) + "\xff";
+        if (i % 41 == 0)
+            id.clear();
+        arena.addElement(id);
+        mem.addElement(id);
+    }
+    auto collect = [](auto it, auto end) {
+        std::vector<std::string> out;
+        for (; it != end; ++it)
+            out.push_back(std::string(*it));
+        return out;
+    };
+    CHECK(collect(arena.begin_order(), arena.end_order()) == collect(mem.begin_order(), mem.end_order()));
+    CHECK(collect(arena.begin_reverse_order(), arena.end_reverse_order()) == collect(mem.begin_reverse_order(), mem.end_reverse_order()));
+    CHECK(collect(arena.begin_middle_out_order(), arena.end_middle_out_order()) == collect(mem.begin_middle_out_order(), mem.end_middle_out_order()));
+    CHECK(collect(arena.begin_ascending_order(), arena.end_ascending_order()) == collect(mem.begin_ascending_order(), mem.end_ascending_order()));
+    CHECK(collect(arena.begin_descending_order(), arena.end_descending_order()) == collect(mem.begin_descending_order(), mem.end_descending_order()));
+    CHECK(collect(arena.begin_side_cross_order(), arena.end_side_cross_order()) == collect(mem.begin_side_cross_order(), mem.end_side_cross_order()));
+}
+
+/**
+ * Test: StringContainer removal compacts the arena
+ */
+TEST_CASE("StringContainer removeElement") {
+    StringContainer c;
+    c.addElement("apple");
+    c.addElement("kiwi");
+    c.addElement("apple");
+    c.addElement("banana");
+    CHECK(c.arena_size() == 20);
+    c.removeElement("apple");
+    CHECK(c.size() == 2);
+    CHECK(c.arena_size() == 10);
+    std::ostringstream out;
+    out << c;
+    CHECK(out.str() == "kiwi banana ");
+    CHECK(*c.begin_ascending_order() == "banana");
+    CHECK_THROWS_AS(c.removeElement("apple"), std::invalid_argument);
+    CHECK_THROWS_AS(*c.end_order(), std::out_of_range);
+
+    // Iterators are invalidated by modifications instead of reading a stale permutation.
+    auto desc = c.begin_descending_order();
+    auto side = c.begin_side_cross_order();
+    c.addElement("cherry");
+    CHECK_THROWS_AS(*desc, std::logic_error);
+    CHECK_THROWS_AS(*side, std::logic_error);
+    auto fresh = c.begin_descending_order();
+    c.removeElement("kiwi");
+    CHECK_THROWS_AS(*fresh, std::logic_error);
+    CHECK(*c.begin_descending_order() == "cherry");
+}
+
+/**
+ * Test: KeyedContainer (key column + record column)
+ * Records ordered by a field must come out exactly like MyContainer with the same projection,
+ * in all six orders, and removal must keep both columns aligned.
+ */
+TEST_CASE("KeyedContainer matches MyContainer with a projection") {
+    KeyedContainer<Employee, int Employee::*> keyed(&Employee::age);
+    MyContainer<Employee, std::less<>, int Employee::*> mem(std::less<>(), &Employee::age);
+    for (int i = 0; i < 100; i++) {
+        Employee e{"e" + std::to_string(i), (i * 37) % 23};
+        keyed.addElement(e);
+        mem.addElement(e);
+    }
+    auto collect = [](auto it, auto end) {
+        std::vector<std::string> out;
+        for (; it != end; ++it)
+            out.push_back((*it).name);
+        return out;
+    };
+    CHECK(collect(keyed.begin_ascending_order(), keyed.end_ascending_order()) == collect(mem.begin_ascending_order(), mem.end_ascending_order()));
+    CHECK(collect(keyed.begin_descending_order(), keyed.end_descending_order()) == collect(mem.begin_descending_order(), mem.end_descending_order()));
+    CHECK(collect(keyed.begin_side_cross_order(), keyed.end_side_cross_order()) == collect(mem.begin_side_cross_order(), mem.end_side_cross_order()));
+    CHECK(collect(keyed.begin_reverse_order(), keyed.end_reverse_order()) == collect(mem.begin_reverse_order(), mem.end_reverse_order()));
+    CHECK(collect(keyed.begin_order(), keyed.end_order()) == collect(mem.begin_order(), mem.end_order()));
+    CHECK(collect(keyed.begin_middle_out_order(), keyed.end_middle_out_order()) == collect(mem.begin_middle_out_order(), mem.end_middle_out_order()));
+
+    keyed.removeElement(Employee{"e0", 0});
+    mem.removeElement(Employee{"e0", 0});
+    CHECK(keyed.size() == 99);
+    CHECK(keyed.begin_ascending_order()->age == 0);
+    CHECK(collect(keyed.begin_ascending_order(), keyed.end_ascending_order()) == collect(mem.begin_ascending_order(), mem.end_ascending_order()));
+    CHECK_THROWS_AS(keyed.removeElement(Employee{"e0", 0}), std::invalid_argument);
+
+    auto stale = keyed.begin_side_cross_order();
+    keyed.addElement(Employee{"late", 50});
+    CHECK_THROWS_AS(*stale, std::logic_error);
+}
+
+/**
+ * Test: KeyedContainer with a key type that is not default constructible
+ */
+struct Badge {
+    explicit Badge(int v) : value(v) {}
+    int value;
+    bool operator<(const Badge &other) const { return value < other.value; }
+};
+struct Holder {
+    Badge badge;
+    bool operator==(const Holder &other) const { return badge.value == other.badge.value; }
+};
+
+TEST_CASE("KeyedContainer removal without default constructible keys") {
+    KeyedContainer<Holder, Badge Holder::*> keyed(&Holder::badge);
+    for (int v : {3, 1, 3, 2})
+        keyed.addElement(Holder{Badge(v)});
+    keyed.removeElement(Holder{Badge(3)});
+    CHECK(keyed.size() == 2);
+    CHECK(keyed.begin_ascending_order()->badge.value == 1);
+}
+
+/**
+ * Test: parallel_for_each visits every element exactly once, in every order.
+ */
+TEST_CASE("parallel_for_each visits every element once") {
+    MyContainer<int> c;
+    for (int i = 0; i < 5000; i++)
+        c.addElement((i * 7919) % 5000);
+    TraversalOrder orders[] = {TraversalOrder::Ascending, TraversalOrder::Descending, TraversalOrder::SideCross,
+                               TraversalOrder::Reverse, TraversalOrder::Insertion, TraversalOrder::MiddleOut};
+    for (TraversalOrder order : orders) {
+        std::vector<std::atomic<int>> hits(5000);
+        c.parallel_for_each(order, [&](int value) { hits[static_cast<size_t>(value)]++; }, 64);
+        bool all_once = std::all_of(hits.begin(), hits.end(), [](const std::atomic<int> &h) { return h.load() == 1; });
+        CHECK(all_once);
+    }
+}
+
+/**
+ * Test: parallel_reduce keeps the traversal order
+ * Concatenation is associative but not commutative, so the result must equal the sequential traversal.
+ */
+TEST_CASE("parallel_reduce is ordered") {
+    MyContainer<int> c;
+    for (int i = 0; i < 300; i++)
+        c.addElement((i * 31) % 101);
+    auto to_text = [](int v) { return std::to_string(v) + ","; };
+    auto concat = [](std::string a, const std::string &b) { return a + b; };
+
+    std::string expected;
+    for (auto it = c.begin_side_cross_order(); it != c.end_side_cross_order(); ++it)
+        expected += to_text(*it);
+    CHECK(c.parallel_reduce(TraversalOrder::SideCross, std::string(), to_text, concat, 16) == expected);
+
+    expected.clear();
+    for (auto it = c.begin_middle_out_order(); it != c.end_middle_out_order(); ++it)
+        expected += to_text(*it);
+    CHECK(c.parallel_reduce(TraversalOrder::MiddleOut, std::string(), to_text, concat, 7) == expected);
+
+    MyContainer<int> empty;
+    CHECK(empty.parallel_reduce(TraversalOrder::Ascending, 42, [](int v) { return v; }, std::plus<>()) == 42);
+}
+
+/**
+ * Test: exceptions thrown inside parallel_for_each reach the caller.
+ */
+TEST_CASE("parallel_for_each propagates exceptions") {
+    MyContainer<int> c;
+    for (int i = 0; i < 100; i++)
+        c.addElement(i);
+    CHECK_THROWS_AS(c.parallel_for_each(TraversalOrder::Insertion, [](int v) {
+        if (v == 50)
+            throw std::runtime_error("bad element");
+    }, 8), std::runtime_error);
+}
+
+/**
+ * Test: for_each_chunk hands out every order in chunks
+ * Concatenating the chunks must give the traversal; only the last chunk may be shorter.
+ */
+TEST_CASE("for_each_chunk matches the iterators") {
+    MyContainer<int> c;
+    for (int i = 0; i < 103; i++)
+        c.addElement((i * 53) % 103);
+    auto expected = [&](TraversalOrder order) {
+        std::vector<int> out;
+        switch (order) {
+        case TraversalOrder::Ascending:
+            for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it) out.push_back(*it);
+            break;
+        case TraversalOrder::Descending:
+            for (auto it = c.begin_descending_order(); it != c.end_descending_order(); ++it) out.push_back(*it);
+            break;
+        case TraversalOrder::SideCross:
+            for (auto it = c.begin_side_cross_order(); it != c.end_side_cross_order(); ++it) out.push_back(*it);
+            break;
+        case TraversalOrder::Reverse:
+            for (auto it = c.begin_reverse_order(); it != c.end_reverse_order(); ++it) out.push_back(*it);
+            break;
+        case TraversalOrder::Insertion:
+            for (auto it = c.begin_order(); it != c.end_order(); ++it) out.push_back(*it);
+            break;
+        case TraversalOrder::MiddleOut:
+            for (auto it = c.begin_middle_out_order(); it != c.end_middle_out_order(); ++it) out.push_back(*it);
+            break;
+        }
+        return out;
+    };
+    TraversalOrder orders[] = {TraversalOrder::Ascending, TraversalOrder::Descending, TraversalOrder::SideCross,
+                               TraversalOrder::Reverse, TraversalOrder::Insertion, TraversalOrder::MiddleOut};
+    for (TraversalOrder order : orders) {
+        std::vector<int> got;
+        std::vector<size_t> sizes;
+        c.for_each_chunk(order, 16, [&](std::span<const int> chunk) {
+            sizes.push_back(chunk.size());
+            got.insert(got.end(), chunk.begin(), chunk.end());
+        });
+        CHECK(got == expected(order));
+        CHECK(sizes.size() == 7);
+        CHECK(sizes.back() == 7);
+    }
+    CHECK_THROWS_AS(c.for_each_chunk(TraversalOrder::Insertion, 0, [](std::span<const int>) {}), std::invalid_argument);
+}
+
+/**
+ * Test: next_batch and next_span on an iterator
+ */
+TEST_CASE("Iterator next_batch and next_span") {
+    MyContainer<int> c;
+    c.addElement(5);
+    c.addElement(1);
+    c.addElement(4);
+    c.addElement(2);
+    c.addElement(3);
+    auto it = c.begin_ascending_order();
+    int out[2];
+    CHECK(it.next_batch(out) == 2);
+    CHECK(out[0] == 1);
+    CHECK(out[1] == 2);
+    auto view = it.next_span(10);
+    CHECK(view.size() == 3);
+    CHECK(view[0] == 3);
+    CHECK(view[2] == 5);
+    CHECK(it == c.end_ascending_order());
+    CHECK(it.next_batch(out) == 0);
+}
+
+/**
+ * Checks contains, count and removeElement of one arithmetic type against the scalar algorithms,
+ * with sizes that leave a scalar tail after the vector loop.
+ */
+template <typename V>
+void check_simd_kernels() {
+    for (int n : {0, 1, 7, 31, 64, 257}) {
+        MyContainer<V> c;
+        std::vector<V> ref;
+        for (int i = 0; i < n; i++) {
+            V value = static_cast<V>((i * 7) % 5);
+            c.addElement(value);
+            ref.push_back(value);
+        }
+        for (int probe = 0; probe < 6; probe++) {
+            V value = static_cast<V>(probe);
+            CHECK(c.count(value) == static_cast<size_t>(std::count(ref.begin(), ref.end(), value)));
+            CHECK(c.contains(value) == (std::find(ref.begin(), ref.end(), value) != ref.end()));
+        }
+        if (n >= 7) {
+            c.removeElement(static_cast<V>(3));
+            ref.erase(std::remove(ref.begin(), ref.end(), static_cast<V>(3)), ref.end());
+            std::vector<V> got;
+            for (auto it = c.begin_order(); it != c.end_order(); ++it)
+                got.push_back(*it);
+            CHECK(got == ref);
+        }
+    }
+}
+
+/**
+ * Test: vectorized contains, count and removeElement agree with std::count / std::find / std::remove
+ * for every lane width and for floating point types.
+ */
+TEST_CASE("SIMD contains, count and removeElement") {
+    check_simd_kernels<signed char>();
+    check_simd_kernels<short>();
+    check_simd_kernels<int>();
+    check_simd_kernels<unsigned>();
+    check_simd_kernels<long long>();
+    check_simd_kernels<float>();
+    check_simd_kernels<double>();
+}
+
+/**
+ * Test: floating point equality semantics are kept by the vector kernels.
+ */
+TEST_CASE("SIMD kernels follow operator== for floating point") {
+    MyContainer<double> c;
+    for (int i = 0; i < 20; i++)
+        c.addElement(i % 2 ? -0.0 : std::nan(""));
+    CHECK(c.count(0.0) == 10);
+    CHECK_FALSE(c.contains(std::nan("")));
+    c.removeElement(0.0);
+    CHECK(c.size() == 10);
+
+    MyContainer<std::string> s;
+    s.addElement("x");
+    s.addElement("y");
+    s.addElement("x");
+    CHECK(s.count("x") == 2);
+    CHECK_FALSE(s.contains("z"));
+}
+
+/**
+ * Test: tracked aggregates
+ * min and max follow insertions and are recomputed after the current extreme is removed;
+ * sum, mean and variance match a direct computation.
+ */
+TEST_CASE("Tracked aggregates: min, max, sum, mean, variance") {
+    MyContainer<int> c;
+    c.track_aggregates();
+    CHECK_THROWS_AS(c.min(), std::out_of_range);
+    CHECK_THROWS_AS(c.mean(), std::out_of_range);
+    CHECK(c.sum() == 0);
+    for (int v : {7, 15, 6, 1, 2, 15})
+        c.addElement(v);
+    CHECK(c.min() == 1);
+    CHECK(c.max() == 15);
+    CHECK(c.sum() == 46);
+    CHECK(c.mean() == doctest::Approx(46.0 / 6));
+    double m = 46.0 / 6, var = 0;
+    for (int v : {7, 15, 6, 1, 2, 15})
+        var += (v - m) * (v - m);
+    CHECK(c.variance() == doctest::Approx(var / 6));
+
+    c.removeElement(15);
+    c.removeElement(1);
+    CHECK(c.max() == 7);
+    CHECK(c.min() == 2);
+    CHECK(c.sum() == 15);
+    CHECK(c.variance() == doctest::Approx((4.0 + 1.0 + 9.0) / 3));
+
+    c.removeElement(7);
+    c.removeElement(6);
+    c.removeElement(2);
+    CHECK_THROWS_AS(c.max(), std::out_of_range);
+    c.addElement(-4);
+    CHECK(c.min() == -4);
+    CHECK(c.max() == -4);
+    CHECK(c.variance() == 0);
+}
+
+/**
+ * Test: compensated floating point sum
+ * Small values added to a large one are lost by a naive sum but kept by the compensated one,
+ * with and without tracking.
+ */
+TEST_CASE("Aggregates use a compensated sum") {
+    MyContainer<double> tracked, untracked;
+    tracked.track_aggregates();
+    tracked.addElement(1e16);
+    untracked.addElement(1e16);
+    for (int i = 0; i < 10; i++) {
+        tracked.addElement(1.0);
+        untracked.addElement(1.0);
+    }
+    CHECK(tracked.sum() == 1e16 + 10);
+    CHECK(untracked.sum() == 1e16 + 10);
+    tracked.removeElement(1e16);
+    CHECK(tracked.sum() == 10);
+    CHECK(tracked.min() == 1.0);
+}
+
+/**
+ * Test: min and max follow the container's comparator and projection.
+ */
+TEST_CASE("Aggregates min and max with a projection") {
+    MyContainer<Employee, std::less<>, int Employee::*> c(std::less<>(), &Employee::age);
+    c.track_aggregates();
+    c.addElement({"dana", 41});
+    c.addElement({"avi", 29});
+    c.addElement({"tal", 29});
+    c.addElement({"noa", 41});
+    CHECK(c.min().name == "avi");
+    CHECK(c.max().name == (*c.begin_descending_order()).name);
+    c.removeElement({"noa", 41});
+    CHECK(c.max().name == "dana");
+}
+
+/**
+ * Test: order statistics
+ * nth_smallest, median and quantile agree with the ascending traversal, whether they are answered
+ * by quickselect, by the repeated-query path or by the cached sorted view.
+ */
+TEST_CASE("Order statistics: nth_smallest, median, quantile") {
+    MyContainer<int> c;
+    std::vector<int> ref;
+    for (int i = 0; i < 101; i++) {
+        int v = (i * 37) % 101;
+        c.addElement(v);
+        ref.push_back(v);
+    }
+    std::sort(ref.begin(), ref.end());
+    CHECK(c.median() == 50);
+    CHECK(c.median() == 50);
+    CHECK(c.nth_smallest(3) == 3);
+    CHECK(c.quantile(0.99) == ref[99]);
+    CHECK(c.quantile(0.0) == 0);
+    CHECK(c.quantile(1.0) == 100);
+    CHECK(c.sorted_view().size() == 101);
+    CHECK(std::equal(ref.begin(), ref.end(), c.sorted_view().begin()));
+
+    c.addElement(-5);
+    CHECK(c.nth_smallest(0) == -5);
+    CHECK(c.median() == 49);
+    CHECK_THROWS_AS(c.nth_smallest(102), std::out_of_range);
+    CHECK_THROWS_AS(c.quantile(1.5), std::invalid_argument);
+    MyContainer<int> empty;
+    CHECK_THROWS_AS(empty.median(), std::out_of_range);
+}
+
+/**
+ * Test: quickselect keeps the stable order of equal keys
+ * The k-th smallest must be the same record as position k of the ascending traversal.
+ */
+TEST_CASE("nth_smallest matches the ascending traversal with equal keys") {
+    MyContainer<Employee, std::less<>, int Employee::*> c(std::less<>(), &Employee::age);
+    for (int i = 0; i < 40; i++)
+        c.addElement({"e" + std::to_string(i), i % 4});
+    std::vector<std::string> ascending;
+    for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it)
+        ascending.push_back((*it).name);
+    MyContainer<Employee, std::less<>, int Employee::*> fresh(std::less<>(), &Employee::age);
+    for (int i = 0; i < 40; i++)
+        fresh.addElement({"e" + std::to_string(i), i % 4});
+    CHECK(fresh.nth_smallest(13).name == ascending[13]);
+    CHECK(fresh.nth_smallest(27).name == ascending[27]);
+}
+
+/**
+ * Test: concurrent const readers
+ * Several threads query an unsorted container at once; the lazily built caches are built once under
+ * their lock and every reader sees the same answers (meant to be run under ThreadSanitizer too).
+ */
+TEST_CASE("Concurrent const readers share the lazily built caches") {
+    MyContainer<int> c;
+    c.track_aggregates();
+    std::vector<int> ref;
+    for (int i = 0; i < 2000; i++) {
+        int v = (i * 7919) % 2003;
+        c.addElement(v);
+        ref.push_back(v);
+    }
+    std::sort(ref.begin(), ref.end());
+    c.removeElement(ref.front());
+    ref.erase(ref.begin());
+    std::atomic<int> mismatches{0};
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; t++)
+        readers.emplace_back([&, t] {
+            for (size_t k = static_cast<size_t>(t); k < ref.size(); k += 97) {
+                if (c.nth_smallest(k) != ref[k] || c.min() != ref.front() || c.max() != ref.back())
+                    mismatches++;
+                MyContainer<int> copy = c;
+                if (copy.sorted_view()[k] != ref[k])
+                    mismatches++;
+            }
+        });
+    for (auto &reader : readers)
+        reader.join();
+    CHECK(mismatches == 0);
+    CHECK(c.has_sorted_view());
+    CHECK(std::equal(ref.begin(), ref.end(), c.sorted_view().begin()));
+}
+
+/**
+ * Test: bounded value ranges
+ * ascending_range / descending_range return the elements with keys in [lo, hi], from the filtered
+ * unsorted storage and from the cached sorted view alike.
+ */
+TEST_CASE("ascending_range and descending_range") {
+    MyContainer<int> c;
+    for (int v : {9, 3, 7, 3, 12, 5, 1, 7})
+        c.addElement(v);
+    auto collect = [](const auto &range) {
+        std::vector<int> out;
+        for (auto it = range.begin(); it != range.end(); ++it)
+            out.push_back(*it);
+        return out;
+    };
+    CHECK(collect(c.ascending_range(3, 7)) == std::vector<int>{3, 3, 5, 7, 7});
+    CHECK(collect(c.descending_range(9, 4)) == std::vector<int>{9, 7, 7, 5});
+    CHECK(c.ascending_range(8, 2).empty());
+    CHECK(c.ascending_range(13, 20).empty());
+
+    c.sorted_view();
+    CHECK(collect(c.ascending_range(3, 7)) == std::vector<int>{3, 3, 5, 7, 7});
+    CHECK(collect(c.descending_range(9, 4)) == std::vector<int>{9, 7, 7, 5});
+    CHECK(collect(c.ascending_range(0, 100)).size() == c.size());
+
+    MyContainer<Employee, std::less<>, int Employee::*> staff(std::less<>(), &Employee::age);
+    staff.addElement({"Dana", 40});
+    staff.addElement({"Avi", 30});
+    staff.addElement({"Moran", 35});
+    staff.addElement({"Gil", 30});
+    std::vector<std::string> names;
+    for (const Employee &e : staff.ascending_range(30, 35))
+        names.push_back(e.name);
+    CHECK(names == std::vector<std::string>{"Avi", "Gil", "Moran"});
+    CHECK_THROWS_AS(*staff.ascending_range(50, 60).begin(), std::out_of_range);
+}
+
+/**
+ * Test: ordered lookups
+ * rank, predecessor, successor, count_between and the positioned iterators returned by
+ * lower_bound / upper_bound, including misses at both ends.
+ */
+TEST_CASE("rank, predecessor, successor, count_between, lower_bound, upper_bound") {
+    MyContainer<int> c;
+    for (int v : {10, 40, 20, 30, 20, 50})
+        c.addElement(v);
+    CHECK(c.rank(5) == 0);
+    CHECK(c.rank(20) == 1);
+    CHECK(c.rank(25) == 3);
+    CHECK(c.rank(99) == 6);
+    CHECK(c.predecessor(20) == 10);
+    CHECK(c.predecessor(10) == std::nullopt);
+    CHECK(c.successor(20) == 30);
+    CHECK(c.successor(50) == std::nullopt);
+    CHECK(c.count_between(20, 40) == 4);
+    CHECK(c.count_between(41, 49) == 0);
+    CHECK(c.count_between(40, 20) == 0);
+
+    std::vector<int> tail;
+    for (auto it = c.lower_bound(20); it != c.end_ascending_order(); ++it)
+        tail.push_back(*it);
+    CHECK(tail == std::vector<int>{20, 20, 30, 40, 50});
+    CHECK(*c.upper_bound(20) == 30);
+    CHECK(c.upper_bound(50) == c.end_ascending_order());
+    CHECK(c.lower_bound(0) == c.begin_ascending_order());
+
+    c.addElement(15);
+    CHECK(c.rank(20) == 2);
+    CHECK(c.predecessor(20) == 15);
+    MyContainer<int> empty;
+    CHECK(empty.rank(1) == 0);
+    CHECK(empty.successor(1) == std::nullopt);
+}
+
+/**
+ * Test: container generation
+ * The generation changes on every modification and on assignment; checked builds reject stale
+ * iterators and views, unchecked builds keep working on the iterator's snapshot.
+ */
+TEST_CASE("Generation counter and stale iterators") {
+    MyContainer<int> c;
+    c.addElement(3);
+    c.addElement(1);
+    auto g = c.generation();
+    c.sorted_view();
+    c.median();
+    CHECK(c.generation() == g);
+    auto it = c.begin_ascending_order();
+    auto range = c.ascending_range(0, 10);
+    c.addElement(2);
+    CHECK(c.generation() != g);
+    auto g2 = c.generation();
+    CHECK_THROWS(c.removeElement(42));
+    CHECK(c.generation() == g2);
+    MyContainer<int> other;
+    other.addElement(1);
+    c = other;
+    CHECK(c.generation() != g2);
+#ifdef ARIEL_CHECKED_ITERATORS
+    CHECK_THROWS_AS(*it, std::logic_error);
+    CHECK_THROWS_AS(it != c.end_ascending_order(), std::logic_error);
+    CHECK_THROWS_AS(*range.begin(), std::logic_error);
+#else
+    CHECK(*it == 1);
+#endif
+    CHECK(*c.begin_ascending_order() == 1);
+
+    // Generations are per container: assignment and moving-from still move past every saved value.
+    MyContainer<int> x, y;
+    x.addElement(1);
+    y.addElement(2);
+    auto gx = x.generation(), gy = y.generation();
+    x = y;
+    CHECK(x.generation() > gx);
+    CHECK(x.generation() > gy);
+    MyContainer<int> z(std::move(y));
+    CHECK(z.generation() == gy);
+    CHECK(y.generation() != gy);
+    x = std::move(z);
+    CHECK(z.generation() != gy);
+    CHECK(*x.begin_order() == 2);
+}
+
+/**
+ * Test: compile-time container
+ * StaticContainer is filled, modified and traversed in constant expressions; the static_asserts
+ * check the six orders at compile time, the test case checks the same at run time.
+ */
+constexpr ariel::StaticContainer<int, 8> make_static_sample() {
+    ariel::StaticContainer<int, 8> c;
+    for (int v : {7, 15, 6, 1, 2, 9})
+        c.addElement(v);
+    c.removeElement(9);
+    return c;
+}
+
+constexpr std::array<int, 5> static_order(ariel::TraversalOrder order) {
+    auto all = make_static_sample().to_array(order);
+    return {all[0], all[1], all[2], all[3], all[4]};
+}
+
+static_assert(make_static_sample().size() == 5);
+static_assert(static_order(ariel::TraversalOrder::Ascending) == std::array<int, 5>{1, 2, 6, 7, 15});
+static_assert(static_order(ariel::TraversalOrder::Descending) == std::array<int, 5>{15, 7, 6, 2, 1});
+static_assert(static_order(ariel::TraversalOrder::SideCross) == std::array<int, 5>{1, 15, 2, 7, 6});
+static_assert(static_order(ariel::TraversalOrder::Reverse) == std::array<int, 5>{2, 1, 6, 15, 7});
+static_assert(static_order(ariel::TraversalOrder::Insertion) == std::array<int, 5>{7, 15, 6, 1, 2});
+static_assert(static_order(ariel::TraversalOrder::MiddleOut) == std::array<int, 5>{6, 15, 1, 7, 2});
+static_assert(*make_static_sample().begin_ascending_order() == 1);
+
+TEST_CASE("StaticContainer traversals at compile time and run time") {
+    static constexpr auto table = make_static_sample().to_array(ariel::TraversalOrder::Ascending);
+    CHECK(table[0] == 1);
+    CHECK(table[4] == 15);
+
+    ariel::StaticContainer<int, 8> c = make_static_sample();
+    std::vector<int> side;
+    for (auto it = c.begin_side_cross_order(); it != c.end_side_cross_order(); ++it)
+        side.push_back(*it);
+    CHECK(side == std::vector<int>{1, 15, 2, 7, 6});
+    std::vector<int> middle;
+    for (auto it = c.begin_middle_out_order(); it != c.end_middle_out_order(); ++it)
+        middle.push_back(*it);
+    CHECK(middle == std::vector<int>{6, 15, 1, 7, 2});
+
+    ariel::StaticContainer<int, 2> tiny;
+    tiny.addElement(1);
+    tiny.addElement(1);
+    CHECK_THROWS_AS(tiny.addElement(2), std::length_error);
+    CHECK_THROWS_AS(tiny.removeElement(5), std::invalid_argument);
+    tiny.removeElement(1);
+    CHECK(tiny.size() == 0);
+    CHECK(tiny.begin_ascending_order() == tiny.end_ascending_order());
+}
+
+/**
+ * Test: small-buffer storage
+ * A container within its inline capacity performs no heap allocation for insertion, removal or
+ * any of the six traversals; past the capacity it spills to the heap and keeps working.
+ */
+TEST_CASE("Inline capacity: no heap allocation for small containers") {
+    using Small = MyContainer<int, std::less<>, std::identity, 16>;
+    Small c;
+    size_t before = heap_allocations.load();
+    for (int v : {7, 15, 6, 1, 2, 9, 4})
+        c.addElement(v);
+    c.removeElement(9);
+    int sum = 0;
+    for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it)
+        sum += *it;
+    for (auto it = c.begin_descending_order(); it != c.end_descending_order(); ++it)
+        sum += *it;
+    for (auto it = c.begin_side_cross_order(); it != c.end_side_cross_order(); ++it)
+        sum += *it;
+    for (auto it = c.begin_reverse_order(); it != c.end_reverse_order(); ++it)
+        sum += *it;
+    for (auto it = c.begin_order(); it != c.end_order(); ++it)
+        sum += *it;
+    for (auto it = c.begin_middle_out_order(); it != c.end_middle_out_order(); ++it)
+        sum += *it;
+    size_t after = heap_allocations.load();
+    CHECK(after == before);
+    CHECK(sum == 6 * 35);
+
+    std::vector<int> side;
+    for (auto it = c.begin_side_cross_order(); it != c.end_side_cross_order(); ++it)
+        side.push_back(*it);
+    CHECK(side == std::vector<int>{1, 15, 2, 7, 4, 6});
+
+    for (int i = 0; i < 40; i++)
+        c.addElement(100 - i);
+    CHECK(c.size() == 46);
+    CHECK(*c.begin_ascending_order() == 1);
+    CHECK(*c.begin_descending_order() == 100);
+    CHECK(c.median() == 77);
+    Small copy = c;
+    c.removeElement(100);
+    CHECK(copy.size() == 46);
+    CHECK(c.size() == 45);
+}
+
+/**
+ * Test: inline storage with non-trivial elements
+ * Records with std::string members are copied, moved and sorted stably within and past the inline capacity.
+ */
+TEST_CASE("Inline capacity with records") {
+    MyContainer<Employee, std::less<>, int Employee::*, 4> staff(std::less<>(), &Employee::age);
+    staff.addElement({"Dana", 40});
+    staff.addElement({"Avi", 30});
+    staff.addElement({"Gil", 30});
+    std::vector<std::string> names;
+    for (auto it = staff.begin_ascending_order(); it != staff.end_ascending_order(); ++it)
+        names.push_back((*it).name);
+    CHECK(names == std::vector<std::string>{"Avi", "Gil", "Dana"});
+    staff.addElement({"Moran", 35});
+    staff.addElement({"Noa", 25});
+    names.clear();
+    for (auto it = staff.begin_ascending_order(); it != staff.end_ascending_order(); ++it)
+        names.push_back((*it).name);
+    CHECK(names == std::vector<std::string>{"Noa", "Avi", "Gil", "Moran", "Dana"});
+    auto moved = std::move(staff);
+    CHECK(moved.size() == 5);
+    moved.removeElement({"Avi", 30});
+    CHECK(moved.size() == 4);
+}
+
+/**
+ * Test: strong guarantee of the inline storage's copy assignment
+ * When copying an element throws, the assigned-to container keeps its elements, inline and on the heap.
+ */
+struct Fragile {
+    static inline int copies_left = -1; //< Copies allowed before throwing (-1: unlimited).
+    int value = 0;
+    Fragile(int v) : value(v) {}
+    Fragile(const Fragile &other) : value(other.value) {
+        if (copies_left == 0)
+            throw std::runtime_error("copy failed");
+        if (copies_left > 0)
+            copies_left--;
+    }
+    Fragile(Fragile &&) noexcept = default;
+    Fragile &operator=(const Fragile &) = default;
+    Fragile &operator=(Fragile &&) noexcept = default;
+};
+
+TEST_CASE("Inline capacity: copy assignment leaves the target unchanged if a copy throws") {
+    using Fragiles = MyContainer<Fragile, std::less<>, int Fragile::*, 4>;
+    auto values = [](const Fragiles &c) {
+        std::vector<int> out;
+        for (auto it = c.begin_order(); it != c.end_order(); ++it)
+            out.push_back((*it).value);
+        return out;
+    };
+    Fragiles source(std::less<>(), &Fragile::value);
+    for (int v : {5, 6, 7})
+        source.addElement(Fragile(v));
+    for (int size : {2, 6}) {
+        Fragiles target(std::less<>(), &Fragile::value);
+        std::vector<int> expected;
+        for (int i = 0; i < size; i++) {
+            target.addElement(Fragile(i));
+            expected.push_back(i);
+        }
+        Fragile::copies_left = 1;
+        CHECK_THROWS_AS(target = source, std::runtime_error);
+        Fragile::copies_left = -1;
+        CHECK(values(target) == expected);
+        target = source;
+        CHECK(values(target) == std::vector<int>{5, 6, 7});
+    }
+}
+
+/**
+ * Test: coroutine generators
+ * generate(order) yields the same sequence as the iterator of every order (equal keys included),
+ * can be consumed partially and interleaved, and ends with std::nullopt.
+ */
+TEST_CASE("generate yields every traversal order lazily") {
+    MyContainer<Employee, std::less<>, int Employee::*> staff(std::less<>(), &Employee::age);
+    for (int i = 0; i < 23; i++)
+        staff.addElement({"e" + std::to_string(i), (i * 7) % 5});
+    auto names_of = [](auto begin, auto end) {
+        std::vector<std::string> out;
+        for (auto it = begin; it != end; ++it)
+            out.push_back((*it).name);
+        return out;
+    };
+    auto generated = [&](TraversalOrder order) {
+        std::vector<std::string> out;
+        for (const Employee &e : staff.generate(order))
+            out.push_back(e.name);
+        return out;
+    };
+    CHECK(generated(TraversalOrder::Ascending) == names_of(staff.begin_ascending_order(), staff.end_ascending_order()));
+    CHECK(generated(TraversalOrder::Descending) == names_of(staff.begin_descending_order(), staff.end_descending_order()));
+    CHECK(generated(TraversalOrder::SideCross) == names_of(staff.begin_side_cross_order(), staff.end_side_cross_order()));
+    CHECK(generated(TraversalOrder::Reverse) == names_of(staff.begin_reverse_order(), staff.end_reverse_order()));
+    CHECK(generated(TraversalOrder::Insertion) == names_of(staff.begin_order(), staff.end_order()));
+    CHECK(generated(TraversalOrder::MiddleOut) == names_of(staff.begin_middle_out_order(), staff.end_middle_out_order()));
+
+    MyContainer<int> a, b;
+    for (int v : {5, 1, 3})
+        a.addElement(v);
+    for (int v : {4, 2})
+        b.addElement(v);
+    auto ga = a.generate(TraversalOrder::Ascending);
+    auto gb = b.generate(TraversalOrder::Descending);
+    std::vector<int> interleaved;
+    for (int i = 0; i < 3; i++) {
+        if (auto v = ga.next())
+            interleaved.push_back(*v);
+        if (auto v = gb.next())
+            interleaved.push_back(*v);
+    }
+    CHECK(interleaved == std::vector<int>{1, 4, 3, 2, 5});
+    CHECK(ga.next() == std::nullopt);
+
+    MyContainer<int> empty;
+    CHECK(empty.generate(TraversalOrder::SideCross).next() == std::nullopt);
+#ifdef ARIEL_CHECKED_ITERATORS
+    auto stale = a.generate(TraversalOrder::Insertion);
+    CHECK(stale.next() == 5);
+    a.addElement(9);
+    CHECK_THROWS_AS(stale.next(), std::logic_error);
+#endif
+}
+
+/**
+ * Test: streaming container, single thread
+ * Elements below the watermark are emitted in ascending order; the rest waits for a higher
+ * watermark or for close(). An element below a published watermark is reported.
+ */
+TEST_CASE("StreamingContainer emits final elements below the watermark") {
+    StreamingContainer<int> s(8);
+    CHECK(s.next() == std::nullopt);
+    for (int v : {5, 1, 9, 3})
+        s.addElement(v);
+    CHECK(s.next() == std::nullopt);
+    s.advance_watermark(6);
+    std::vector<int> out;
+    CHECK(s.consume([&](int v) { out.push_back(v); }) == 3);
+    CHECK(out == std::vector<int>{1, 3, 5});
+    s.addElement(7);
+    s.addElement(6);
+    s.advance_watermark(2);
+    CHECK(s.next() == std::nullopt);
+    CHECK(!s.exhausted());
+    s.close();
+    CHECK_THROWS_AS(s.addElement(1), std::logic_error);
+    s.consume([&](int v) { out.push_back(v); });
+    CHECK(out == std::vector<int>{1, 3, 5, 6, 7, 9});
+    CHECK(s.exhausted());
+
+    StreamingContainer<int> late;
+    late.addElement(4);
+    late.advance_watermark(5);
+    CHECK(late.next() == 4);
+    late.addElement(2);
+    late.addElement(8);
+    late.addElement(6);
+    CHECK_THROWS_AS(late.next(), std::logic_error);
+    // The late element is dropped; the valid ones drained with it are still emitted.
+    CHECK(late.next() == std::nullopt);
+    late.advance_watermark(7);
+    CHECK(late.next() == 6);
+    late.close();
+    CHECK(late.next() == 8);
+    CHECK(late.next() == std::nullopt);
+    CHECK(late.exhausted());
+}
+
+/**
+ * Test: streaming container with concurrent producers
+ * Three producers push increasing sequences and publish their progress; the consumer advances the
+ * watermark to the slowest producer and must see every element exactly once, in ascending order,
+ * while the number of runs stays small.
+ */
+TEST_CASE("StreamingContainer with concurrent producers") {
+    StreamingContainer<int> s(64);
+    constexpr int PRODUCERS = 3, PER_PRODUCER = 4000;
+    std::atomic<int> progress[PRODUCERS];
+    for (auto &p : progress)
+        p = 0;
+    std::vector<std::thread> producers;
+    for (int p = 0; p < PRODUCERS; p++)
+        producers.emplace_back([&, p] {
+            for (int i = 0; i < PER_PRODUCER; i++) {
+                s.addElement(i * PRODUCERS + p);
+                progress[p].store(i + 1, std::memory_order_release);
+            }
+        });
+    std::vector<int> out;
+    size_t max_runs = 0;
+    for (int low = 0; low < PER_PRODUCER;) {
+        low = PER_PRODUCER;
+        for (auto &p : progress)
+            low = std::min(low, p.load(std::memory_order_acquire));
+        s.advance_watermark(low * PRODUCERS);
+        if (s.consume([&](int v) { out.push_back(v); }) == 0)
+            std::this_thread::yield();
+        max_runs = std::max(max_runs, s.run_count());
+    }
+    for (auto &t : producers)
+        t.join();
+    s.close();
+    s.consume([&](int v) { out.push_back(v); });
+    CHECK(s.exhausted());
+    CHECK(out.size() == static_cast<size_t>(PRODUCERS * PER_PRODUCER));
+    CHECK(std::is_sorted(out.begin(), out.end()));
+    CHECK(std::adjacent_find(out.begin(), out.end()) == out.end());
+    CHECK(max_runs < 40);
+}
+
+/**
+ * Test: producer filling the queue before the first watermark
+ * The consumer drains the queue even while no watermark is published, so a producer pushing more
+ * elements than the queue holds is not blocked forever; nothing is emitted before the watermark.
+ */
+TEST_CASE("StreamingContainer drains the queue before the first watermark") {
+    StreamingContainer<int> s(8);
+    constexpr int COUNT = 100;
+    std::atomic<bool> published{false};
+    std::vector<int> early, out;
+    std::thread consumer([&] {
+        while (!s.exhausted()) {
+            if (auto v = s.next())
+                (published.load() ? out : early).push_back(*v);
+            else
+                std::this_thread::yield();
+        }
+    });
+    for (int i = COUNT; i > 0; i--)
+        s.addElement(i);
+    published = true;
+    s.advance_watermark(COUNT + 1);
+    s.close();
+    consumer.join();
+    CHECK(early.empty());
+    CHECK(out.size() == static_cast<size_t>(COUNT));
+    CHECK(std::is_sorted(out.begin(), out.end()));
+}
+
+/**
+ * Test: k-way merge across containers
+ * merge_ascending / merge_descending over shards equal the ascending / descending traversal of the
+ * concatenated shards, equal keys included; empty shards and a single shard are handled.
+ */
+TEST_CASE("merge_ascending and merge_descending across shards") {
+    using Staff = MyContainer<Employee, std::less<>, int Employee::*>;
+    std::vector<Staff> shards(5, Staff(std::less<>(), &Employee::age));
+    Staff all(std::less<>(), &Employee::age);
+    for (int i = 0; i < 5; i++)
+        for (int j = 0; j < 4 * i; j++) {
+            Employee e{"s" + std::to_string(i) + "_" + std::to_string(j), (i * 13 + j * 7) % 9};
+            shards[static_cast<size_t>(i)].addElement(e);
+            all.addElement(e);
+        }
+    std::vector<const Staff *> pointers;
+    for (const Staff &s : shards)
+        pointers.push_back(&s);
+
+    std::vector<std::string> merged, expected;
+    for (const Employee &e : merge_ascending(pointers))
+        merged.push_back(e.name);
+    for (auto it = all.begin_ascending_order(); it != all.end_ascending_order(); ++it)
+        expected.push_back((*it).name);
+    CHECK(merged == expected);
+
+    merged.clear();
+    expected.clear();
+    for (const Employee &e : merge_descending(pointers))
+        merged.push_back(e.name);
+    for (auto it = all.begin_descending_order(); it != all.end_descending_order(); ++it)
+        expected.push_back((*it).name);
+    CHECK(merged == expected);
+
+    MyContainer<int> a, b, c;
+    for (int v : {5, 1, 9})
+        a.addElement(v);
+    for (int v : {2, 8})
+        c.addElement(v);
+    std::vector<int> ints;
+    for (int v : merge_ascending(a, b, c))
+        ints.push_back(v);
+    CHECK(ints == std::vector<int>{1, 2, 5, 8, 9});
+    ints.clear();
+    for (int v : merge_descending(a))
+        ints.push_back(v);
+    CHECK(ints == std::vector<int>{9, 5, 1});
+    CHECK(merge_ascending(std::vector<const MyContainer<int> *>{}).next() == std::nullopt);
+}
+
+/**
+ * Test: multiset operations
+ * set_union, set_intersection, set_difference and symmetric_difference give the same multisets
+ * through the hash join (unsorted operands) and through the galloping merge (sorted operands),
+ * and agree with the std:: algorithms on sorted vectors.
+ */
+TEST_CASE("Set operations between containers") {
+    auto sorted_contents = [](const MyContainer<int> &c) {
+        std::vector<int> out;
+        for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it)
+            out.push_back(*it);
+        return out;
+    };
+    std::vector<int> va = {7, 1, 3, 3, 3, 9, 12, 5}, vb = {3, 9, 9, 2, 3, 20};
+    for (bool sorted : {false, true}) {
+        MyContainer<int> a, b;
+        for (int v : va)
+            a.addElement(v);
+        for (int v : vb)
+            b.addElement(v);
+        if (sorted) {
+            a.sorted_view();
+            b.sorted_view();
+        }
+        std::vector<int> sa = va, sb = vb, expected;
+        std::sort(sa.begin(), sa.end());
+        std::sort(sb.begin(), sb.end());
+        std::set_union(sa.begin(), sa.end(), sb.begin(), sb.end(), std::back_inserter(expected));
+        CHECK(sorted_contents(set_union(a, b)) == expected);
+        expected.clear();
+        std::set_intersection(sa.begin(), sa.end(), sb.begin(), sb.end(), std::back_inserter(expected));
+        CHECK(sorted_contents(set_intersection(a, b)) == expected);
+        expected.clear();
+        std::set_difference(sa.begin(), sa.end(), sb.begin(), sb.end(), std::back_inserter(expected));
+        CHECK(sorted_contents(set_difference(a, b)) == expected);
+        expected.clear();
+        std::set_symmetric_difference(sa.begin(), sa.end(), sb.begin(), sb.end(), std::back_inserter(expected));
+        CHECK(sorted_contents(symmetric_difference(a, b)) == expected);
+    }
+
+    MyContainer<int> big, small;
+    for (int i = 0; i < 10000; i++)
+        big.addElement(i * 2);
+    for (int v : {4, 5, 19998, 30000})
+        small.addElement(v);
+    big.sorted_view();
+    CHECK(sorted_contents(set_intersection(small, big)) == std::vector<int>{4, 19998});
+    CHECK(sorted_contents(set_difference(small, big)) == std::vector<int>{5, 30000});
+    CHECK(set_union(small, big).size() == 10002);
+
+    MyContainer<Employee, std::less<>, int Employee::*> x(std::less<>(), &Employee::age), y(std::less<>(), &Employee::age);
+    x.addElement({"Dana", 30});
+    y.addElement({"Avi", 30});
+    y.addElement({"Gil", 40});
+    auto common = set_intersection(x, y);
+    REQUIRE(common.size() == 1);
+    CHECK((*common.begin_order()).name == "Dana");
+}
+
+/**
+ * Test: container in POSIX shared memory
+ */
+TEST_CASE("SharedContainer is shared between processes")
+{
+    std::string name = "/ariel_test_" + std::to_string(getpid());
+    SharedContainer<int>::remove(name);
+    auto loader = SharedContainer<int>::create(name, 8);
+    CHECK_THROWS_AS(SharedContainer<int>::create(name, 8), std::system_error);
+    for (int v : {7, 15, 6, 1, 2})
+        loader.addElement(v);
+    loader.build_index();
+    CHECK(loader.capacity() == 8);
+
+    auto reader = SharedContainer<int>::open(name);
+    CHECK(reader.size() == 5);
+    CHECK(reader.version() == loader.version());
+    auto collect = [](auto begin, auto end)
+    {
+        std::vector<int> out;
+        for (auto it = begin; it != end; ++it)
+            out.push_back(*it);
+        return out;
+    };
+    {
+        auto guard = reader.read_lock();
+        CHECK(collect(reader.begin_ascending_order(), reader.end_ascending_order()) == std::vector<int>{1, 2, 6, 7, 15});
+        CHECK(collect(reader.begin_descending_order(), reader.end_descending_order()) == std::vector<int>{15, 7, 6, 2, 1});
+        CHECK(collect(reader.begin_side_cross_order(), reader.end_side_cross_order()) == std::vector<int>{1, 15, 2, 7, 6});
+        CHECK(collect(reader.begin_reverse_order(), reader.end_reverse_order()) == std::vector<int>{2, 1, 6, 15, 7});
+        CHECK(collect(reader.begin_order(), reader.end_order()) == std::vector<int>{7, 15, 6, 1, 2});
+        CHECK(collect(reader.begin_middle_out_order(), reader.end_middle_out_order()) == std::vector<int>{6, 15, 1, 7, 2});
+    }
+
+    // A separate process (this binary, running only the child test case below) attaches by name,
+    // reads without allocating, and modifies the container. It is spawned rather than forked, because
+    // the test runner already has worker threads.
+    std::string segment = "ARIEL_SHARED_SEGMENT=" + name;
+    std::string filter = "--test-case=SharedContainer child process";
+    char *child_argv[] = {const_cast<char *>("test"), filter.data(), const_cast<char *>("--minimal"), nullptr};
+    char *child_env[] = {segment.data(), nullptr};
+    pid_t child = 0;
+    REQUIRE(posix_spawn(&child, "/proc/self/exe", nullptr, nullptr, child_argv, child_env) == 0);
+    int status = 0;
+    waitpid(child, &status, 0);
+    REQUIRE(WIFEXITED(status));
+    CHECK(WEXITSTATUS(status) == 0);
+
+    CHECK(loader.size() == 6);
+    auto it = reader.begin_order();
+    CHECK(collect(reader.begin_ascending_order(), reader.end_ascending_order()) == std::vector<int>{1, 2, 3, 6, 7, 15});
+    loader.removeElement(15);
+    CHECK_THROWS_AS(*it, std::logic_error);
+    CHECK_THROWS_AS(loader.removeElement(100), std::invalid_argument);
+    for (int v : {4, 5, 8})
+        loader.addElement(v);
+    CHECK_THROWS_AS(loader.addElement(9), std::length_error);
+    {
+        auto guard = reader.read_lock();
+        CHECK_THROWS_AS(reader.begin_ascending_order(), std::logic_error);
+    }
+    CHECK(SharedContainer<int>::remove(name));
+    CHECK_FALSE(SharedContainer<int>::remove(name));
+    CHECK_THROWS_AS(SharedContainer<int>::open(name), std::system_error);
+}
+
+/**
+ * Test: the other process of "SharedContainer is shared between processes"
+ * Does nothing unless ARIEL_SHARED_SEGMENT names the segment to attach to.
+ */
+TEST_CASE("SharedContainer child process")
+{
+    const char *name = std::getenv("ARIEL_SHARED_SEGMENT");
+    if (!name)
+        return;
+    auto attached = SharedContainer<int>::open(name);
+    size_t before = heap_allocations.load();
+    int expected[] = {1, 2, 6, 7, 15};
+    size_t i = 0;
+    bool exact = true;
+    for (auto it = attached.begin_ascending_order(); it != attached.end_ascending_order(); ++it)
+        exact = exact && i < 5 && *it == expected[i++];
+    size_t allocations = heap_allocations.load() - before;
+    CHECK(exact);
+    CHECK(i == 5);
+    CHECK(allocations == 0);
+    attached.addElement(3);
+}
+
+/**
+ * Test: distinct and grouped ascending traversal
+ */
+TEST_CASE("distinct_ascending and grouped_ascending")
+{
+    using Group = std::pair<int, size_t>;
+    MyContainer<int> c;
+    for (int round = 0; round < 3; round++)
+        for (int v : {5, 3, 5, 9, 3, 5, 1, 9, 5, 3, 5, 5})
+            c.addElement(v);
+    std::vector<Group> expected = {{1, 3}, {3, 9}, {5, 18}, {9, 6}};
+
+    // Hash counting (no sorted representation yet), then runs of the sorted view.
+    std::vector<Group> hashed;
+    for (const auto &group : c.grouped_ascending())
+        hashed.push_back(group);
+    CHECK(hashed == expected);
+    CHECK_FALSE(c.has_sorted_view());
+    c.sorted_view();
+    std::vector<Group> from_view;
+    for (const auto &group : c.grouped_ascending())
+        from_view.push_back(group);
+    CHECK(from_view == expected);
+    std::vector<int> distinct;
+    for (int v : c.distinct_ascending())
+        distinct.push_back(v);
+    CHECK(distinct == std::vector<int>{1, 3, 5, 9});
+
+    // Mostly distinct keys fall back to sorting.
+    MyContainer<int> spread;
+    for (int v = 20; v > 0; v--)
+        spread.addElement(v % 10);
+    size_t groups = 0;
+    for (const auto &[value, copies] : spread.grouped_ascending())
+    {
+        CHECK(value == static_cast<int>(groups));
+        CHECK(copies == 2);
+        groups++;
+    }
+    CHECK(groups == 10);
+    CHECK(MyContainer<int>().grouped_ascending().next() == std::nullopt);
+
+    // The first element of every group in the ascending traversal represents it; custom orders too.
+    MyContainer<std::pair<int, char>, std::greater<>, decltype([](const std::pair<int, char> &p)
+                                                              { return p.first; })>
+        keyed;
+    for (auto p : {std::pair{1, 'a'}, std::pair{2, 'b'}, std::pair{1, 'c'}, std::pair{2, 'd'}})
+        keyed.addElement(p);
+    std::vector<std::pair<std::pair<int, char>, size_t>> by_key;
+    for (const auto &group : keyed.grouped_ascending())
+        by_key.push_back(group);
+    REQUIRE(by_key.size() == 2);
+    CHECK(by_key[0] == std::pair{std::pair{2, 'b'}, size_t(2)});
+    CHECK(by_key[1] == std::pair{std::pair{1, 'a'}, size_t(2)});
+}
+
+/**
+ * Test: removal by position and unordered removal mode
+ */
+TEST_CASE("erase_at, erase(iterator) and unordered removal")
+{
+    auto contents = [](const auto &c)
+    {
+        std::vector<int> out;
+        for (auto it = c.begin_order(); it != c.end_order(); ++it)
+            out.push_back(*it);
+        return out;
+    };
+    MyContainer<int> c;
+    for (int v : {7, 15, 6, 1, 2})
+        c.addElement(v);
+    c.erase_at(1);
+    CHECK(contents(c) == std::vector<int>{7, 6, 1, 2});
+    CHECK_THROWS_AS(c.erase_at(4), std::out_of_range);
+
+    // Every traversal order maps its position back to the right element.
+    auto asc = c.begin_ascending_order();
+    ++asc;
+    c.erase(asc); // 2
+    CHECK(contents(c) == std::vector<int>{7, 6, 1});
+    auto desc = c.begin_descending_order();
+    c.erase(desc); // 7
+    CHECK(contents(c) == std::vector<int>{6, 1});
+    c.addElement(9);
+    auto middle = c.begin_middle_out_order();
+    c.erase(middle); // 1
+    CHECK(contents(c) == std::vector<int>{6, 9});
+    auto reverse = c.begin_reverse_order();
+    c.erase(reverse); // 9
+    CHECK(contents(c) == std::vector<int>{6});
+
+    MyContainer<int> other;
+    other.addElement(6);
+    CHECK_THROWS_AS(c.erase(other.begin_order()), std::invalid_argument);
+    CHECK_THROWS_AS(c.erase(c.end_order()), std::out_of_range);
+    auto stale = c.begin_order();
+    c.addElement(3);
+    CHECK_THROWS_AS(c.erase(stale), std::logic_error);
+    auto same_size = c.begin_ascending_order();
+    c.addElement(8);
+    c.removeElement(3);
+    CHECK_THROWS_AS(c.erase(same_size), std::logic_error);
+
+    // Swap-and-pop: the last element fills the gap, the value orders stay exact.
+    MyContainer<int, std::less<>, std::identity, 4> u;
+    u.unordered_removal();
+    for (int v : {7, 15, 6, 1, 2, 9})
+        u.addElement(v);
+    u.erase_at(1);
+    CHECK(contents(u) == std::vector<int>{7, 9, 6, 1, 2});
+    u.erase_at(4);
+    CHECK(contents(u) == std::vector<int>{7, 9, 6, 1});
+    auto side = u.begin_side_cross_order();
+    ++side;
+    u.erase(side); // 9
+    CHECK(contents(u) == std::vector<int>{7, 1, 6});
+    std::vector<int> sorted;
+    for (auto it = u.begin_ascending_order(); it != u.end_ascending_order(); ++it)
+        sorted.push_back(*it);
+    CHECK(sorted == std::vector<int>{1, 6, 7});
+    u.track_aggregates();
+    u.erase_at(0);
+    CHECK(u.max() == 6);
+    CHECK(u.sum() == 7);
+
+    // Removing by position needs no operator== on the element type.
+    struct Rec {
+        int id;
+        double weight;
+    };
+    MyContainer<Rec, std::less<>, int Rec::*> records(std::less<>{}, &Rec::id);
+    for (Rec r : {Rec{3, 0.5}, Rec{1, 2.0}, Rec{2, 1.5}})
+        records.addElement(r);
+    records.track_aggregates();
+    records.erase_at(1);
+    CHECK(records.size() == 2);
+    CHECK(records.min().id == 2);
+    records.erase(records.begin_descending_order());
+    CHECK(records.max().id == 2);
+}
+
+/**
+ * Test: predicate removal and removal of the first occurrence
+ */
+TEST_CASE("remove_if and remove_first")
+{
+    auto contents = [](const auto &c)
+    {
+        std::vector<int> out;
+        for (auto it = c.begin_order(); it != c.end_order(); ++it)
+            out.push_back(*it);
+        return out;
+    };
+    MyContainer<int> c;
+    for (int v : {4, 7, 4, 10, 3, 4, 8})
+        c.addElement(v);
+    c.track_aggregates();
+    CHECK(c.remove_if([](int v)
+                      { return v % 2 == 0 && v > 4; }) == 2);
+    CHECK(contents(c) == std::vector<int>{4, 7, 4, 3, 4});
+    CHECK(c.max() == 7);
+    CHECK(c.sum() == 22);
+    CHECK(c.remove_if([](int v)
+                      { return v > 100; }) == 0);
+
+    CHECK(c.remove_first(4));
+    CHECK(contents(c) == std::vector<int>{7, 4, 3, 4});
+    CHECK_FALSE(c.remove_first(42));
+    CHECK(c.sum() == 18);
+    std::vector<int> sorted;
+    for (auto it = c.begin_ascending_order(); it != c.end_ascending_order(); ++it)
+        sorted.push_back(*it);
+    CHECK(sorted == std::vector<int>{3, 4, 4, 7});
+
+    // removeElement still removes every occurrence.
+    c.removeElement(4);
+    CHECK(contents(c) == std::vector<int>{7, 3});
+}
+
+/**
+ * Test: SharedContainer iterator snapshots under a concurrent writer
+ * The writer adds 0, 1, 2, ... through its own handle; every ascending traversal that is not
+ * rejected as stale must see exactly 0..k-1 for some k.
+ */
+TEST_CASE("SharedContainer iterators take a consistent snapshot") {
+    std::string name = "/ariel_snapshot_" + std::to_string(getpid());
+    SharedContainer<int>::remove(name);
+    constexpr int N = 2000;
+    auto writer_handle = SharedContainer<int>::create(name, N);
+    auto reader = SharedContainer<int>::open(name);
+    std::thread writer([&writer_handle] {
+        for (int v = 0; v < N; v++)
+            writer_handle.addElement(v);
+    });
+    size_t consistent = 0;
+    bool done = false;
+    while (!done) {
+        done = reader.size() == N;
+        auto it = reader.begin_ascending_order();
+        auto end = reader.end_ascending_order();
+        auto guard = reader.read_lock();
+        std::vector<int> seen;
+        try {
+            for (; it != end; ++it)
+                seen.push_back(*it);
+        } catch (const std::logic_error &) {
+            continue;
+        }
+        bool exact = true;
+        for (size_t i = 0; i < seen.size(); i++)
+            exact = exact && seen[i] == static_cast<int>(i);
+        CHECK(exact);
+        consistent++;
+    }
+    writer.join();
+    CHECK(consistent > 0);
+    SharedContainer<int>::remove(name);
+}
+
+/**
+ * Test: opening a segment that does not match its header
+ * A segment cut shorter than its header says, a foreign segment and a segment of another element
+ * type are rejected by open() instead of being mapped (reading past the end would raise SIGBUS).
+ * Move assignment hands the mapping over and releases the previous one.
+ */
+TEST_CASE("SharedContainer open validates the segment") {
+    std::string name = "/ariel_validate_" + std::to_string(getpid());
+    SharedContainer<int>::remove(name);
+    auto owner = SharedContainer<int>::create(name, 1000);
+    owner.addElement(3);
+    CHECK_THROWS_AS(SharedContainer<double>::open(name), std::runtime_error);
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    REQUIRE(fd >= 0);
+    REQUIRE(ftruncate(fd, 512) == 0);
+    CHECK_THROWS_AS(SharedContainer<int>::open(name), std::runtime_error);
+    REQUIRE(ftruncate(fd, 0) == 0);
+    CHECK_THROWS_AS(SharedContainer<int>::open(name), std::runtime_error);
+    REQUIRE(ftruncate(fd, 8192) == 0);
+    CHECK_THROWS_AS(SharedContainer<int>::open(name), std::runtime_error);
+    close(fd);
+    SharedContainer<int>::remove(name);
+
+    auto first = SharedContainer<int>::create(name, 4);
+    first.addElement(1);
+    std::string other_name = name + "_b";
+    SharedContainer<int>::remove(other_name);
+    auto second = SharedContainer<int>::create(other_name, 4);
+    second.addElement(2);
+    second.addElement(5);
+    first = std::move(second);
+    CHECK(first.size() == 2);
+    CHECK(*first.begin_descending_order() == 5);
+    SharedContainer<int>::remove(name);
+    SharedContainer<int>::remove(other_name);
+}